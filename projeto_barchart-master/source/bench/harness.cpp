@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "harness.h"
+
+namespace bench {
+
+    namespace {
+        /// Every benchmark, in registration order.
+        std::vector< std::unique_ptr< Benchmark > > & registry( void )
+        {
+            static std::vector< std::unique_ptr< Benchmark > > benchmarks;
+            return benchmarks;
+        }
+
+        /// Formats a rate with a k/M/G suffix, e.g. `12.5MB/s`.
+        std::string human( double rate, const char * unit = "" )
+        {
+            const char * suffix[] = { "", "k", "M", "G" };
+            std::size_t s{ 0 };
+            while ( rate >= 1000.0 && s < 3 ) { rate /= 1000.0; ++s; }
+            char buf[32];
+            std::snprintf( buf, sizeof( buf ), "%.1f%s%s/s", rate, suffix[s], unit );
+            return buf;
+        }
+
+        void usage( const char * name )
+        {
+            std::fprintf( stderr, "Usage: %s [--filter <text>] [--size <n>] [--min-time <seconds>]\n"
+                                  "  --filter <text>      Runs only the benchmarks whose name contains <text>.\n"
+                                  "  --size <n>           Runs every benchmark with a dataset of <n> items.\n"
+                                  "  --min-time <seconds> Minimum time of a measured run. Default is 0.5.\n", name );
+        }
+    }
+
+    Benchmark * Benchmark::Range( std::int64_t lo, std::int64_t hi )
+    {
+        for ( auto arg = std::max< std::int64_t >( lo, 1 ); arg <= hi; arg *= 8 ) m_args.push_back( arg );
+        if ( m_args.empty() || m_args.back() != hi ) m_args.push_back( hi );
+        return this;
+    }
+
+    Benchmark * register_benchmark( const char * name, Function fn )
+    {
+        registry().push_back( std::make_unique< Benchmark >( name, fn ) );
+        return registry().back().get();
+    }
+
+    int run_all( int argc, char ** argv )
+    {
+        std::string filter;
+        std::int64_t size{ 0 };
+        double min_time{ 0.5 };
+        for ( int i{ 1 }; i < argc; ++i )
+        {
+            const std::string param{ argv[i] };
+            if ( param == "--filter" && i + 1 < argc ) filter = argv[++i];
+            else if ( param == "--size" && i + 1 < argc ) size = std::atoll( argv[++i] );
+            else if ( param == "--min-time" && i + 1 < argc ) min_time = std::atof( argv[++i] );
+            else { usage( argv[0] ); return param == "-h" || param == "--help" ? EXIT_SUCCESS : EXIT_FAILURE; }
+        }
+
+        std::printf( "%-32s %14s %12s %14s %12s\n", "Benchmark", "Time/iter", "Iterations", "Items", "Bytes" );
+        std::printf( "%s\n", std::string( 88, '-' ).c_str() );
+        for ( const auto & b : registry() )
+        {
+            if ( !filter.empty() && b->name().find( filter ) == std::string::npos ) continue;
+            auto args = b->args();
+            if ( size > 0 ) args.assign( 1, size );
+            if ( args.empty() ) args.push_back( 0 );
+            for ( auto arg : args )
+            {
+                // Grow the iteration count until a run is long enough to be trusted.
+                std::size_t iterations{ 1 };
+                for ( ;; )
+                {
+                    State state{ arg, iterations };
+                    b->function()( state );
+                    if ( state.skipped() )
+                    {
+                        const std::string name = b->name() + "/" + std::to_string( arg );
+                        std::printf( "%-32s %14s   (%s)\n", name.c_str(), "skipped", state.skip_reason().c_str() );
+                        std::fflush( stdout );
+                        break;
+                    }
+                    const double seconds = std::chrono::duration< double >( state.elapsed() ).count();
+                    if ( seconds >= min_time || iterations >= 1000000000 )
+                    {
+                        const double ns = seconds * 1e9 / iterations;
+                        const std::string name = b->name() + "/" + std::to_string( arg );
+                        const std::string items = state.items_processed() > 0 ? human( state.items_processed() / seconds ) : "";
+                        const std::string bytes = state.bytes_processed() > 0 ? human( state.bytes_processed() / seconds, "B" ) : "";
+                        std::printf( "%-32s %11.0f ns %12zu %14s %12s\n", name.c_str(), ns, iterations, items.c_str(), bytes.c_str() );
+                        std::fflush( stdout );
+                        break;
+                    }
+                    const double grow = seconds > 0.0 ? min_time / seconds * 1.4 : 10.0;
+                    iterations = static_cast<std::size_t>( iterations * std::clamp( grow, 2.0, 10.0 ) );
+                }
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+} // namespace bench.
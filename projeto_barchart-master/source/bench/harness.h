@@ -0,0 +1,128 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+/*!
+ * A tiny micro-benchmark harness, in the style of Google Benchmark.
+ *
+ * ```c++
+ *      static void BM_something( bench::State & state )
+ *      {
+ *          auto input = make_input( state.range() );  // Not timed.
+ *          while ( state.keep_running() )             // Timed.
+ *              bench::do_not_optimize( something( input ) );
+ *          state.set_items_processed( state.iterations() * input.size() );
+ *      }
+ *      BENCHMARK( BM_something )->Arg( 1000 )->Arg( 100000 );
+ * ```
+ * The runner repeats each benchmark with more and more iterations until one
+ * run takes at least the minimum time, then reports the time per iteration.
+ * A benchmark that cannot run here (e.g. the CPU lacks its instruction set)
+ * calls `state.skip( "why" )` instead of the loop, and is listed as skipped.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+    /// Keeps the compiler from optimizing `value` (and what computed it) away.
+    template < typename T >
+    inline void do_not_optimize( const T & value )
+    {
+#if defined( __GNUC__ ) || defined( __clang__ )
+        asm volatile( "" : : "r,m"( value ) : "memory" );
+#else
+        static volatile const void * sink;
+        sink = &value;
+#endif
+    }
+
+    /// What a benchmark function gets: its argument and the iteration loop.
+    class State {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            State( std::int64_t arg, std::size_t iterations ) : m_arg{ arg }, m_iterations{ iterations } {}
+
+            /// True while there are iterations left. The clock runs from the first call to the last.
+            bool keep_running( void )
+            {
+                if ( m_done == 0 && !m_started ) { m_started = true; m_start = clock::now(); }
+                if ( m_done < m_iterations ) { ++m_done; return true; }
+                m_stop = clock::now();
+                return false;
+            }
+
+            /// The argument of this run (the dataset size).
+            std::int64_t range( void ) const { return m_arg; }
+            /// # of iterations of this run.
+            std::size_t iterations( void ) const { return m_iterations; }
+            /// Items handled by the whole run, for the items/s column.
+            void set_items_processed( std::int64_t n ) { m_items = n; }
+            /// Bytes handled by the whole run, for the MB/s column.
+            void set_bytes_processed( std::int64_t n ) { m_bytes = n; }
+            /// Gives up on the run, for `reason`. Call it instead of the `keep_running()` loop.
+            void skip( std::string reason ) { m_skip_reason = std::move( reason ); }
+
+            /// True if the benchmark called `skip()`.
+            bool skipped( void ) const { return !m_skip_reason.empty(); }
+            const std::string & skip_reason( void ) const { return m_skip_reason; }
+
+            std::int64_t items_processed( void ) const { return m_items; }
+            std::int64_t bytes_processed( void ) const { return m_bytes; }
+            /// Time spent in the loop.
+            clock::duration elapsed( void ) const { return m_stop - m_start; }
+
+        private:
+            std::int64_t m_arg;
+            std::size_t m_iterations;
+            std::size_t m_done = 0;
+            bool m_started = false;
+            clock::time_point m_start{};
+            clock::time_point m_stop{};
+            std::int64_t m_items = 0;
+            std::int64_t m_bytes = 0;
+            std::string m_skip_reason;
+    };
+
+    using Function = void ( * )( State & );
+
+    /// A registered benchmark and the arguments it runs with.
+    class Benchmark {
+        public:
+            Benchmark( std::string name, Function fn ) : m_name{ std::move( name ) }, m_fn{ fn } {}
+            /// Adds one argument.
+            Benchmark * Arg( std::int64_t arg ) { m_args.push_back( arg ); return this; }
+            /// Adds `lo`, `lo * 8`, `lo * 64`, ... up to `hi`.
+            Benchmark * Range( std::int64_t lo, std::int64_t hi );
+
+            const std::string & name( void ) const { return m_name; }
+            Function function( void ) const { return m_fn; }
+            const std::vector< std::int64_t > & args( void ) const { return m_args; }
+
+        private:
+            std::string m_name;
+            Function m_fn;
+            std::vector< std::int64_t > m_args;
+    };
+
+    /// Adds a benchmark to the global list. Use the `BENCHMARK` macro instead.
+    Benchmark * register_benchmark( const char * name, Function fn );
+
+    /// Runs the registered benchmarks, as selected by the command line. Returns the exit code.
+    /*!
+     * Options: `--filter <text>` (only names containing text), `--size <n>` (replace every
+     * argument by n), `--min-time <seconds>` (default 0.5).
+     */
+    int run_all( int argc, char ** argv );
+} // namespace bench.
+
+#define BENCH_CONCAT2( a, b ) a##b
+#define BENCH_CONCAT( a, b ) BENCH_CONCAT2( a, b )
+#define BENCHMARK( fn ) \
+    static ::bench::Benchmark * BENCH_CONCAT( bench_registered_, __LINE__ ) = ::bench::register_benchmark( #fn, fn )
+
+#endif
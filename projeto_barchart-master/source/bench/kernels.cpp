@@ -0,0 +1,414 @@
+/*!
+ * Micro-benchmarks of the kernels a frame goes through: splitting a data line,
+ * parsing its value, coloring text, ranking the bars, finding the color of a
+ * category, and the expression parser of `source2`.
+ *
+ * The argument of every benchmark is the size of its synthetic dataset (lines,
+ * strings, bars, lookups or expressions). Run `bcr_bench --size <n>` to try
+ * another size, and configure with `-DCMAKE_BUILD_TYPE=Release` for numbers
+ * that mean something.
+ */
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+
+#include "barchart.h"
+#include "bcr_am.h"
+#include "color_registry.h"
+#include "frame_arena.h"
+#include "intern.h"
+#include "loader.h"
+#include "tokenizer.h"
+#include "value_kernels.h"
+#include "value_parser.h"
+#include "parser.h"
+#include "text_color.h"
+
+namespace {
+    /// Same seed every run, so that numbers are comparable across builds.
+    std::mt19937 & rng( void )
+    {
+        static std::mt19937 gen{ 20240601u };
+        return gen;
+    }
+
+    /// Data lines like the ones of a dataset: `timestamp,label,country,value,category`.
+    std::vector< std::string > make_lines( std::size_t n )
+    {
+        std::uniform_int_distribution< int > value{ 1000, 40000000 };
+        std::uniform_int_distribution< int > pick{ 0, 999 };
+        std::vector< std::string > lines;
+        lines.reserve( n );
+        for ( std::size_t i{ 0 }; i < n; ++i )
+        {
+            const int id = pick( rng() );
+            lines.push_back( "1975-01-01,City number " + std::to_string( id ) + ",Country " + std::to_string( id % 97 )
+                             + "," + std::to_string( value( rng() ) ) + ",Region " + std::to_string( id % 12 ) );
+        }
+        return lines;
+    }
+
+    std::int64_t total_bytes( const std::vector< std::string > & strings )
+    {
+        std::int64_t bytes{ 0 };
+        for ( const auto & s : strings ) bytes += static_cast<std::int64_t>( s.size() );
+        return bytes;
+    }
+
+    /// A chart of `n` bars with distinct labels and random values.
+    bcra::BarChart make_chart( std::size_t n )
+    {
+        auto & table = bcra::interned();
+        std::uniform_int_distribution< bcra::value_t > value{ 1, 100000000 };
+        bcra::BarChart chart;
+        for ( std::size_t i{ 0 }; i < n; ++i )
+            chart.add( table.labels.intern( "Bench label " + std::to_string( i ) ), value( rng() ),
+                       table.categories.intern( "Bench category " + std::to_string( i % 12 ) ) );
+        return chart;
+    }
+
+    //=== Line splitting.
+
+    /// The tokenizer ingest used before `split_fields()`, kept as the baseline.
+    std::vector< std::string > istringstream_split( const std::string & input_str, char delimiter )
+    {
+        std::vector< std::string > tokens;
+        std::istringstream iss;
+        iss.str( input_str );
+        std::string token;
+        while ( std::getline( iss >> std::ws, token, delimiter ) )
+            tokens.push_back( token );
+        return tokens;
+    }
+
+    void BM_istringstream_split( bench::State & state )
+    {
+        const auto lines = make_lines( state.range() );
+        while ( state.keep_running() )
+            for ( const auto & line : lines ) bench::do_not_optimize( istringstream_split( line, ',' ) );
+        state.set_items_processed( state.iterations() * lines.size() );
+        state.set_bytes_processed( state.iterations() * total_bytes( lines ) );
+    }
+    BENCHMARK( BM_istringstream_split )->Arg( 1000 )->Arg( 100000 );
+
+    template < std::size_t ( *Split )( std::string_view, char, bcra::Fields & ) >
+    void split_fields_with( bench::State & state )
+    {
+        const auto lines = make_lines( state.range() );
+        bcra::Fields fields;
+        while ( state.keep_running() )
+            for ( const auto & line : lines ) bench::do_not_optimize( Split( line, ',', fields ) );
+        state.set_items_processed( state.iterations() * lines.size() );
+        state.set_bytes_processed( state.iterations() * total_bytes( lines ) );
+    }
+
+    /// Whatever `split_fields()` picks on this machine.
+    void BM_split_fields( bench::State & state ) { split_fields_with< bcra::split_fields >( state ); }
+    BENCHMARK( BM_split_fields )->Arg( 1000 )->Arg( 100000 );
+    void BM_split_fields_scalar( bench::State & state ) { split_fields_with< bcra::detail::split_fields_scalar >( state ); }
+    BENCHMARK( BM_split_fields_scalar )->Arg( 1000 )->Arg( 100000 );
+    void BM_split_fields_sse2( bench::State & state ) { split_fields_with< bcra::detail::split_fields_sse2 >( state ); }
+    BENCHMARK( BM_split_fields_sse2 )->Arg( 1000 )->Arg( 100000 );
+    void BM_split_fields_avx2( bench::State & state )
+    {
+        if ( std::string_view{ bcra::detail::split_fields_isa() } != "avx2" )
+        {
+            state.skip( "no AVX2 on this CPU" );
+            return;
+        }
+        split_fields_with< bcra::detail::split_fields_avx2 >( state );
+    }
+    BENCHMARK( BM_split_fields_avx2 )->Arg( 1000 )->Arg( 100000 );
+
+    //=== Value parsing.
+
+    /// Values of 1 to 19 digits, as they show up in the value column.
+    std::vector< std::string > make_values( std::size_t n )
+    {
+        std::uniform_int_distribution< int > digits{ 1, 18 };
+        std::vector< std::string > values;
+        values.reserve( n );
+        for ( std::size_t i{ 0 }; i < n; ++i )
+        {
+            std::uniform_int_distribution< long long > value{ 0, static_cast<long long>( std::pow( 10.0, digits( rng() ) ) ) };
+            values.push_back( std::to_string( value( rng() ) ) );
+        }
+        return values;
+    }
+
+    /// `std::stol()`, as the loader used to parse values.
+    void BM_stol( bench::State & state )
+    {
+        const auto values = make_values( state.range() );
+        while ( state.keep_running() )
+            for ( const auto & v : values ) bench::do_not_optimize( std::stol( v ) );
+        state.set_items_processed( state.iterations() * values.size() );
+        state.set_bytes_processed( state.iterations() * total_bytes( values ) );
+    }
+    BENCHMARK( BM_stol )->Arg( 1000 )->Arg( 100000 );
+
+    void BM_parse_value( bench::State & state )
+    {
+        const auto values = make_values( state.range() );
+        bcra::value_t value{ 0 };
+        while ( state.keep_running() )
+            for ( const auto & v : values )
+            {
+                bench::do_not_optimize( bcra::parse_value( v, value ) );
+                bench::do_not_optimize( value );
+            }
+        state.set_items_processed( state.iterations() * values.size() );
+        state.set_bytes_processed( state.iterations() * total_bytes( values ) );
+    }
+    BENCHMARK( BM_parse_value )->Arg( 1000 )->Arg( 100000 );
+
+    /// Fixed point with thousands separators: "12,345,678.90".
+    void BM_parse_value_formatted( bench::State & state )
+    {
+        std::vector< std::string > values;
+        for ( const auto & v : make_values( state.range() ) )
+        {
+            std::string text;
+            for ( std::size_t i{ 0 }; i < v.size(); ++i )
+            {
+                if ( i > 0 && ( v.size() - i ) % 3 == 0 ) text += ',';
+                text += v[i];
+            }
+            values.push_back( text + ".90" );
+        }
+        bcra::ValueFormat format;
+        format.thousands = ',';
+        format.decimals = 2;
+        bcra::value_t value{ 0 };
+        while ( state.keep_running() )
+            for ( const auto & v : values )
+            {
+                bench::do_not_optimize( bcra::parse_value( v, value, format ) );
+                bench::do_not_optimize( value );
+            }
+        state.set_items_processed( state.iterations() * values.size() );
+        state.set_bytes_processed( state.iterations() * total_bytes( values ) );
+    }
+    BENCHMARK( BM_parse_value_formatted )->Arg( 1000 )->Arg( 100000 );
+
+    //=== Colored text.
+
+    void BM_tcolor( bench::State & state )
+    {
+        const auto labels = make_lines( state.range() );
+        while ( state.keep_running() )
+            for ( std::size_t i{ 0 }; i < labels.size(); ++i )
+                bench::do_not_optimize( Color::tcolor( labels[i], Color::color_list[i % Color::color_list.size()] ) );
+        state.set_items_processed( state.iterations() * labels.size() );
+    }
+    BENCHMARK( BM_tcolor )->Arg( 1000 )->Arg( 100000 );
+
+    void BM_color_append( bench::State & state )
+    {
+        const auto labels = make_lines( state.range() );
+        std::string out;
+        while ( state.keep_running() )
+        {
+            out.clear();
+            for ( std::size_t i{ 0 }; i < labels.size(); ++i )
+                Color::append( out, labels[i], Color::color_list[i % Color::color_list.size()] );
+            bench::do_not_optimize( out.data() );
+        }
+        state.set_items_processed( state.iterations() * labels.size() );
+    }
+    BENCHMARK( BM_color_append )->Arg( 1000 )->Arg( 100000 );
+
+    //=== Scanning the values of a chart.
+
+    void BM_max_bar_value( bench::State & state )
+    {
+        auto chart = make_chart( state.range() );
+        while ( state.keep_running() )
+            bench::do_not_optimize( chart.max_bar_value() );
+        state.set_items_processed( state.iterations() * chart.size() );
+        state.set_bytes_processed( state.iterations() * chart.size() * sizeof( bcra::value_t ) );
+    }
+    BENCHMARK( BM_max_bar_value )->Arg( 100 )->Arg( 10000 )->Arg( 1000000 );
+
+    template < bcra::ValueStats ( *Stats )( const bcra::value_t *, std::size_t ) >
+    void value_stats_with( bench::State & state )
+    {
+        const auto chart = make_chart( state.range() );
+        const auto & values = chart.values();
+        while ( state.keep_running() )
+            bench::do_not_optimize( Stats( values.data(), values.size() ) );
+        state.set_items_processed( state.iterations() * values.size() );
+        state.set_bytes_processed( state.iterations() * values.size() * sizeof( bcra::value_t ) );
+    }
+
+    void BM_value_stats_scalar( bench::State & state ) { value_stats_with< bcra::detail::value_stats_scalar >( state ); }
+    BENCHMARK( BM_value_stats_scalar )->Arg( 16 )->Arg( 10000 )->Arg( 1000000 );
+    void BM_value_stats_avx2( bench::State & state )
+    {
+        if ( std::string_view{ bcra::detail::value_kernels_isa() } != "avx2" )
+        {
+            state.skip( "no AVX2 on this CPU" );
+            return;
+        }
+        value_stats_with< bcra::detail::value_stats_avx2 >( state );
+    }
+    BENCHMARK( BM_value_stats_avx2 )->Arg( 16 )->Arg( 10000 )->Arg( 1000000 );
+
+    /// Bar lengths of a whole chart, scaled so the largest bar is `Cfg::max_bar_length` cells.
+    template < void ( *Widths )( const bcra::value_t *, std::size_t, bcra::value_t, std::size_t, std::uint32_t * ) >
+    void bar_widths_with( bench::State & state )
+    {
+        const auto chart = make_chart( state.range() );
+        const auto & values = chart.values();
+        const auto max = chart.max_bar_value();
+        std::vector< std::uint32_t > widths( values.size() );
+        while ( state.keep_running() )
+        {
+            Widths( values.data(), values.size(), max, bcra::Cfg::max_bar_length, widths.data() );
+            bench::do_not_optimize( widths.data() );
+        }
+        state.set_items_processed( state.iterations() * values.size() );
+    }
+
+    void BM_bar_widths_scalar( bench::State & state ) { bar_widths_with< bcra::detail::bar_widths_scalar >( state ); }
+    BENCHMARK( BM_bar_widths_scalar )->Arg( 16 )->Arg( 10000 )->Arg( 1000000 );
+    void BM_bar_widths_avx2( bench::State & state )
+    {
+        if ( std::string_view{ bcra::detail::value_kernels_isa() } != "avx2" )
+        {
+            state.skip( "no AVX2 on this CPU" );
+            return;
+        }
+        bar_widths_with< bcra::detail::bar_widths_avx2 >( state );
+    }
+    BENCHMARK( BM_bar_widths_avx2 )->Arg( 16 )->Arg( 10000 )->Arg( 1000000 );
+
+    //=== Ranking.
+
+    void BM_sort_full( bench::State & state )
+    {
+        auto chart = make_chart( state.range() );
+        while ( state.keep_running() )
+        {
+            chart.sort();
+            bench::do_not_optimize( chart.ranked( 0 ) );
+        }
+        state.set_items_processed( state.iterations() * chart.size() );
+    }
+    BENCHMARK( BM_sort_full )->Arg( 100 )->Arg( 10000 )->Arg( 1000000 );
+
+    void BM_sort_top15( bench::State & state )
+    {
+        auto chart = make_chart( state.range() );
+        while ( state.keep_running() )
+        {
+            chart.sort( 15 );
+            bench::do_not_optimize( chart.ranked( 0 ) );
+        }
+        state.set_items_processed( state.iterations() * chart.size() );
+    }
+    BENCHMARK( BM_sort_top15 )->Arg( 100 )->Arg( 10000 )->Arg( 1000000 );
+
+    /// Ranking a frame that differs from the previous one by a few values, as in a real race.
+    void BM_rerank_top15( bench::State & state )
+    {
+        auto chart = make_chart( state.range() );
+        bcra::FrameArena arena; // Scratch of the ranking, freed after each frame like in the animation.
+        chart.set_scratch( &arena );
+        chart.rerank( 15 );
+        std::uniform_int_distribution< std::size_t > pick{ 0, chart.size() - 1 };
+        std::uniform_int_distribution< bcra::value_t > delta{ -1000000, 1000000 };
+        const std::size_t changes = chart.size() / 100 + 1; // ~1% of the bars move.
+        while ( state.keep_running() )
+        {
+            for ( std::size_t i{ 0 }; i < changes; ++i )
+            {
+                const auto k = pick( rng() );
+                chart.set_value( k, chart.values()[k] + delta( rng() ) );
+            }
+            chart.rerank( 15 );
+            bench::do_not_optimize( chart.ranked( 0 ) );
+            arena.reset();
+        }
+        state.set_items_processed( state.iterations() * chart.size() );
+    }
+    BENCHMARK( BM_rerank_top15 )->Arg( 100 )->Arg( 10000 )->Arg( 1000000 );
+
+    /// Ranking with no previous order to repair: the first frame, or the frame after a seek.
+    void BM_rerank_seed_top15( bench::State & state )
+    {
+        auto chart = make_chart( state.range() );
+        bcra::FrameArena arena;
+        chart.set_scratch( &arena );
+        while ( state.keep_running() )
+        {
+            chart.reset_rank();
+            chart.rerank( 15 );
+            bench::do_not_optimize( chart.ranked( 0 ) );
+            arena.reset();
+        }
+        state.set_items_processed( state.iterations() * chart.size() );
+    }
+    BENCHMARK( BM_rerank_seed_top15 )->Arg( 100 )->Arg( 10000 )->Arg( 1000000 );
+
+    //=== Category color lookup.
+
+    /// Category name -> color, the way the animation colors a bar: intern id, then color registry.
+    void BM_category_color( bench::State & state )
+    {
+        auto & categories = bcra::interned().categories;
+        std::vector< std::string > names;
+        for ( std::size_t i{ 0 }; i < 64; ++i ) names.push_back( "Lookup category " + std::to_string( i ) );
+        bcra::ColorRegistry colors;
+        for ( const auto & name : names ) colors.add( categories.intern( name ) );
+        std::uniform_int_distribution< std::size_t > pick{ 0, names.size() - 1 };
+        std::vector< std::string_view > queries;
+        for ( std::int64_t i{ 0 }; i < state.range(); ++i ) queries.push_back( names[ pick( rng() ) ] );
+
+        while ( state.keep_running() )
+            for ( auto query : queries ) bench::do_not_optimize( colors.sgr( categories.find( query ) ) );
+        state.set_items_processed( state.iterations() * queries.size() );
+    }
+    BENCHMARK( BM_category_color )->Arg( 1000 )->Arg( 100000 );
+
+    //=== Expression parser (source2).
+
+    /// Expressions like `12 + -345 - 6789 + ...`, with 1 to 16 terms.
+    std::vector< std::string > make_expressions( std::size_t n )
+    {
+        std::uniform_int_distribution< int > terms{ 1, 16 };
+        std::uniform_int_distribution< int > value{ -99999, 99999 };
+        std::uniform_int_distribution< int > coin{ 0, 1 };
+        std::vector< std::string > exprs;
+        exprs.reserve( n );
+        for ( std::size_t i{ 0 }; i < n; ++i )
+        {
+            std::string expr = std::to_string( value( rng() ) );
+            for ( int t{ terms( rng() ) }; t > 1; --t )
+                expr += ( coin( rng() ) ? " + " : " - " ) + std::to_string( value( rng() ) );
+            exprs.push_back( std::move( expr ) );
+        }
+        return exprs;
+    }
+
+    void BM_parser( bench::State & state )
+    {
+        const auto exprs = make_expressions( state.range() );
+        Parser parser;
+        while ( state.keep_running() )
+            for ( const auto & expr : exprs ) bench::do_not_optimize( parser.parse( expr ).type );
+        state.set_items_processed( state.iterations() * exprs.size() );
+        state.set_bytes_processed( state.iterations() * total_bytes( exprs ) );
+    }
+    BENCHMARK( BM_parser )->Arg( 1000 )->Arg( 10000 );
+} // namespace.
+
+int main( int argc, char ** argv )
+{
+    return bench::run_all( argc, argv );
+}
@@ -7,6 +7,7 @@
 
 #include <string>
 using std::string;
+#include <numeric> // iota
 
 
 #include "text_color.h"
@@ -16,23 +17,129 @@ namespace bcra {
     // TODO: Add class implementation here.
 
     // nao � necessario BarChart::  (opcional)
-    inline void BarChart::set_date(std::string d)
+    void BarChart::set_date(std::string d)
     {
-
+        m_date = std::move(d);
     }
     /// Add a single bar to the bar chart.
-    inline void BarChart::add(const string& label, value_t value, const string& category)
+    void BarChart::add(str_id_t label, value_t value, str_id_t category)
     {
-
+        m_labels.push_back(label);
+        m_values.push_back(value);
+        m_categories.push_back(category);
+    }
+    /// Replaces all bars with the ones in the given arrays.
+    void BarChart::assign(const str_id_t* labels, const value_t* values, const str_id_t* categories, std::size_t n)
+    {
+        // Uma copia por coluna, sem montar barra por barra.
+        m_labels.assign(labels, labels + n);
+        m_values.assign(values, values + n);
+        m_categories.assign(categories, categories + n);
+        m_rank.clear();
     }
     /// Remove all bars from the chart.
-    inline void BarChart::clear()
+    void BarChart::clear()
+    {
+        m_labels.clear();
+        m_values.clear();
+        m_categories.clear();
+        m_rank.clear();
+    }
+    /// Ranks the `top_n` largest bars, in descending order.
+    void BarChart::sort(std::size_t top_n)
+    {
+        const value_t* values = m_values.data();
+        const str_id_t* labels = m_labels.data();
+        auto greater = [values, labels](std::uint32_t a, std::uint32_t b) {
+            return values[a] != values[b] ? values[a] > values[b] : labels[a] < labels[b];
+        };
+
+        // Only indices are moved around, never the bars.
+        m_rank.resize(m_values.size());
+        std::iota(m_rank.begin(), m_rank.end(), 0u);
+        if (top_n < m_rank.size())
+        {
+            // Selection in O(n), then only the winners get sorted.
+            std::nth_element(m_rank.begin(), m_rank.begin() + top_n, m_rank.end(), greater);
+            m_rank.resize(top_n);
+        }
+        std::sort(m_rank.begin(), m_rank.end(), greater);
+    }
+
+    /// Ranks the bars reusing the order of the previous frame.
+    void BarChart::rerank(std::size_t top_n)
     {
+        constexpr std::uint32_t npos = static_cast<std::uint32_t>(-1);
+        const value_t* values = m_values.data();
+        const str_id_t* labels = m_labels.data();
+        auto greater = [values, labels](std::uint32_t a, std::uint32_t b) {
+            return values[a] != values[b] ? values[a] > values[b] : labels[a] < labels[b];
+        };
+        const auto n = m_values.size();
 
+        // Where each label is in this frame.
+        for (std::uint32_t i{ 0 }; i < n; ++i)
+        {
+            if (labels[i] >= m_slot.size()) m_slot.resize(labels[i] + 1, npos);
+            m_slot[labels[i]] = i;
+        }
+
+        // Previous order first, then the labels that were not there before.
+        // (Work arrays of this call only: they come from the scratch resource.)
+        std::pmr::vector<std::uint32_t> full{ m_scratch };
+        std::pmr::vector<char> placed(n, 0, m_scratch);
+        full.reserve(n);
+        for (auto label : m_order)
+        {
+            const auto i = label < m_slot.size() ? m_slot[label] : npos;
+            if (i != npos && !placed[i]) { full.push_back(i); placed[i] = 1; }
+        }
+        for (std::uint32_t i{ 0 }; i < n; ++i)
+            if (!placed[i]) full.push_back(i);
+
+        // Insertion sort: each shift is one rank change. With no previous order (first frame,
+        // after a seek) there is nothing to repair, so the order is seeded with one sort instead.
+        const bool seed = m_order.empty();
+        const std::size_t budget = 8 * n + 64;
+        m_rank_moves = 0;
+        if (seed)
+            std::sort(full.begin(), full.end(), greater);
+        for (std::size_t k{ 1 }; !seed && k < n && m_rank_moves <= budget; ++k)
+        {
+            const auto cur = full[k];
+            auto j = k;
+            for (; j > 0 && greater(cur, full[j - 1]); --j)
+                full[j] = full[j - 1];
+            full[j] = cur;
+            m_rank_moves += k - j;
+        }
+        if (m_rank_moves > budget)
+            std::sort(full.begin(), full.end(), greater); // Too much has changed.
+
+        m_order.resize(n);
+        for (std::size_t k{ 0 }; k < n; ++k)
+            m_order[k] = labels[full[k]];
+        for (std::size_t i{ 0 }; i < n; ++i)
+            m_slot[labels[i]] = npos;
+
+        m_rank.assign(full.begin(), full.begin() + std::min(top_n, n));
+    }
+
+    /// Forgets the order kept between frames.
+    void BarChart::reset_rank()
+    {
+        m_order.clear();
     }
-    /// Sort the bars in descending order.
-    inline void BarChart::sort()
+
+    /// Returns the largest value in the chart.
+    value_t BarChart::max_bar_value() const
     {
+        return stats().max;
+    }
 
+    /// Returns the min, max and sum of the values (AVX2 when the CPU has it).
+    ValueStats BarChart::stats() const
+    {
+        return value_stats(m_values.data(), m_values.size());
     }
 }
@@ -22,33 +22,38 @@ using std::sort;
 #include <vector>
 using std::vector;
 
+#include <memory_resource>
+
+#include "../libs/aligned_allocator.h"
 #include "../libs/text_color.h"
+#include "intern.h"
+#include "value_kernels.h"
+#include "value_parser.h" // value_t
 
 namespace bcra {
-    // The value type of a data item.
-    using value_t = long;
-
     /// This class represents a single Bar Chart.
     class BarChart 
     {
         //=== Definition
         public:
             /// Represents a single bar information.
+            /*!
+             * Label and category are ids in the global intern table (see `interned()`),
+             * so comparing or copying a bar never touches a string. The chart does not
+             * store bars like this: a `BarItem` is assembled from its arrays on demand.
+             */
             struct BarItem 
             {
             //public:
-                string label;    //!< Bar label.    // nome da barra (Brasil, Eua, ...)
-                value_t value;   //!< Bar value.    // valor
-                string category; //!< Bar category. // categoria
-                BarItem( string l, value_t v, string c ) : label{l}, value{v}, category{c}
+                str_id_t label;    //!< Bar label.    // nome da barra (Brasil, Eua, ...)
+                value_t value;     //!< Bar value.    // valor
+                str_id_t category; //!< Bar category. // categoria
+                BarItem( str_id_t l, value_t v, str_id_t c ) : label{l}, value{v}, category{c}
                 {/*empty*/}
             };
             
             //== Data members
         public:
-            /// The collection of bars items
-            std::vector< BarItem > bars;
-            
             std::string main_title;
             std::string info_date;
             std::string fonte_date;
@@ -65,8 +70,24 @@ namespace bcra {
             // vou usar mapa para mapear cidade e cor, aleatoriamente ou nao
         private:
 
+            //== The bars, as a struct of arrays: bar `i` is (m_labels[i], m_values[i], m_categories[i]).
+            // Each array starts on a cache line, so scanning the values (max, ranking, scaling)
+            // reads nothing but values, in loops the compiler can vectorize.
+            aligned_vector< value_t > m_values;     //!< Value of each bar.
+            aligned_vector< str_id_t > m_labels;    //!< Label id of each bar.
+            aligned_vector< str_id_t > m_categories; //!< Category id of each bar.
+
             /// The date (timestamp) of the bar chart.
             std::string m_date;
+            /// Indices of the top ranked bars, best first (filled by `sort()`).
+            std::vector< std::uint32_t > m_rank;
+
+            //== State kept between frames by `rerank()`.
+            std::vector< str_id_t > m_order;     //!< Labels of the previous frame, best first.
+            std::vector< std::uint32_t > m_slot; //!< Label id -> index of its bar (scratch, kept all npos).
+            std::size_t m_rank_moves = 0;        //!< Element shifts done by the last `rerank()`.
+            /// Where the work arrays of a ranking are allocated (e.g. a `FrameArena`).
+            std::pmr::memory_resource * m_scratch = std::pmr::new_delete_resource();
 
             //== Public interface
         public:
@@ -74,24 +95,63 @@ namespace bcra {
             //BarChart();
             ~BarChart(){/*empty*/};
             /// Set the bar chart date.
-            inline void set_date( std::string d );
+            void set_date( std::string d );
             /// Add a single bar to the bar chart.
-            inline void add( const string& label, value_t value, const string& category );
+            void add( str_id_t label, value_t value, str_id_t category );
+            /// Replaces all bars with the `n` bars whose fields are in the given arrays.
+            void assign( const str_id_t * labels, const value_t * values, const str_id_t * categories, std::size_t n );
             /// Remove all bars from the chart.
-            inline void clear();
-            /// Sort the bars in descending order.
-            inline void sort();
+            void clear();
+            /// Ranks the `top_n` largest bars, in descending order.
+            /*!
+             * The bars themselves are not reordered: the result is an index list, read through
+             * `ranked()`. Ties are broken by label id, so the order is deterministic.
+             * Costs O(n + top_n log top_n) instead of a full O(n log n) sort.
+             */
+            void sort( std::size_t top_n = static_cast<std::size_t>( -1 ) );
+            /// Same result as `sort()`, but repairs the order of the previous frame.
+            /*!
+             * The bars are laid out in the order their labels had in the previous call
+             * (new labels at the end) and fixed with an insertion sort, so the cost is
+             * O(n + # of rank changes). If the frames are too different, it gives up
+             * and falls back to a full sort. With no previous order (the first call, or
+             * after `reset_rank()`) it goes straight to that sort, which seeds the order
+             * the next frames repair.
+             */
+            void rerank( std::size_t top_n );
+            /// Forgets the order kept by `rerank()` (e.g. after jumping to another frame).
+            void reset_rank( void );
+            /// Allocates the work arrays of `rerank()` from `scratch`, which must outlive each call.
+            void set_scratch( std::pmr::memory_resource * scratch ) { m_scratch = scratch; }
 
             //== Acessor methods.
 
             /// Retrives the bar chart date
             inline string get_date( void ) const { return m_date; }
-            /// Retrives the value of the largest bar.
-            inline value_t max_bar_value ( void );
+            /// Retrives the value of the largest bar (0 if the chart is empty).
+            value_t max_bar_value ( void ) const;
+            /// Min, max and sum of the bar values, in one pass.
+            ValueStats stats( void ) const;
             /// Returns true if the bar chart has no bars.
-            inline bool empty( void ) const { return bars.empty(); }
+            inline bool empty( void ) const { return m_values.empty(); }
             /// Returns the # of bars in the chart.
-            inline size_t size( void ) const { return bars.size(); }
+            inline size_t size( void ) const { return m_values.size(); }
+            /// Returns the `i`-th bar, in the order they were added.
+            inline BarItem bar( size_t i ) const { return BarItem{ m_labels[i], m_values[i], m_categories[i] }; }
+            /// Value of each bar, in the order they were added.
+            inline const aligned_vector< value_t > & values( void ) const { return m_values; }
+            /// Label id of each bar, in the order they were added.
+            inline const aligned_vector< str_id_t > & label_ids( void ) const { return m_labels; }
+            /// Category id of each bar, in the order they were added.
+            inline const aligned_vector< str_id_t > & category_ids( void ) const { return m_categories; }
+            /// Changes the value of the `i`-th bar.
+            inline void set_value( size_t i, value_t value ) { m_values[i] = value; }
+            /// Returns the # of bars ranked by the last `sort()`.
+            inline size_t ranked_size( void ) const { return m_rank.size(); }
+            /// Returns the bar at position `pos` of the ranking (0 is the largest).
+            inline BarItem ranked( size_t pos ) const { return bar( m_rank[pos] ); }
+            /// # of element shifts the last `rerank()` needed (0 means the order did not change).
+            inline size_t rank_moves( void ) const { return m_rank_moves; }
     };
 
 } // namespace bcra.
@@ -1,4 +1,6 @@
 ﻿#include <algorithm>
+#include <array>
+#include <cctype>
 using std::transform;
 #include <string>
 using std::string;
@@ -8,12 +10,18 @@ using std::istringstream;
 
 #include "bcr_am.h"
 #include <iostream>
+#include "../libs/alloc_counter.h"
 #include "../libs/coms.h"
+#include "../libs/mapped_file.h"
+#include "../libs/proc_stats.h"
+#include "loader.h"
+#include "bcrb.h"
 #include "../libs/text_color.h"
 #include <iomanip>  // centralizar strings
 using std::setw;
 
 #include <exception>
+#include <chrono>
 #include <thread>
 #include <fstream>
 
@@ -28,6 +36,14 @@ namespace bcra
         return str;
     };
 
+    /// Formats `value` with a fixed # of decimal places.
+    static std::string fixed(double value, int precision = 1)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(precision) << value;
+        return oss.str();
+    }
+
     /// Lambda expression that transform the string to lowercase.
     auto STR_UPPERCASE = [](const std::string& s)->std::string {
         std::string str{ s };
@@ -35,40 +51,46 @@ namespace bcra
         return str;
     };
 
-    /// Tokenize a string
-    /*!
-     * @param input_str The input string.
-     * @param delimiter The delimiter symbol.
-     * @return A list of tokenized strings.
-     */
-    std::vector<std::string> split(const std::string& input_str, char delimiter)
-    {
-        // Store the tokens.
-        // RETORNAR UMA STRUCT
-        // COM ANO MES E OS CARALHO
-        std::vector<std::string> tokens;
-
-        // read file line by line
-        std::istringstream iss;
-        iss.str(input_str);
-        std::string token;
-        while (std::getline(iss >> std::ws, token, delimiter))
-            tokens.push_back(token);
-
-        return tokens;
-    }
-
-
 
     /// Prints out usage instructions; any incoming string is treated as an error message.
     void BCRAnimation::usage(std::string msg = "") {
         if (msg != "") std::cerr << "ERR: " << msg << "\n\n";
         std::cerr << "Usage: bcr [<options>] <input_data_file>\n"
+            << "       bcr --compile <input_data_file> <output.bcrb>\n"
             << "  Bar Chart Race options:\n"
             << "      -b  <num> Max # of bars in a single char.\n"
             << "                Valid range is [1,15]. Default values is 5.\n"
             << "      -f  <num> Animation speed in fps (frames per second).\n"
-            << "                Valid range is [1,24]. Default value is 24.\n";
+            << "                Valid range is [1,24]. Default value is 24.\n"
+            << "      -t  <num> # of in-between frames drawn between two charts, so bars\n"
+            << "                slide smoothly. Valid range is [0,60]. Default value is 0.\n"
+            << "      -j  <num> # of threads used to read the input file.\n"
+            << "                Default value is 0 (one per core).\n"
+            << "      --stream  Reads the charts while playing, keeping only a few of them\n"
+            << "                in memory. Useful for huge input files.\n"
+            << "      --no-diff Redraws the whole screen on every frame, instead of only\n"
+            << "                what changed. Output that is not a terminal is never diffed.\n"
+            << "      --bench   Plays the whole race as fast as possible into the null device\n"
+            << "                and reports load time, frames/s, ns per stage and peak memory.\n"
+            << "      --thousands <char> Thousands separator of the values (e.g. '.' for 1.234.567).\n"
+            << "                Quote the values when it is also the field delimiter.\n"
+            << "      --decimals <num> Keeps <num> decimal places of the values, in [0,9].\n"
+            << "                Default is 0, where values with decimal places are malformed.\n"
+            << "                A binary dataset plays with the decimals it was compiled with;\n"
+            << "                if given, <num> must match them.\n"
+            << "      --decimal-point <char> Starts the decimal places. Default is '.'.\n"
+            << "      --colors <16|256|truecolor> Colors of the categories past the first 14:\n"
+            << "                16 (they share one color), 256 or truecolor. Default is 256.\n"
+            << "      --from <time> Starts the race at the first chart stamped <time> or later.\n"
+            << "      --to <time> Ends the race at the last chart stamped <time> or earlier.\n"
+            << "      --compile <in> <out>  Parses <in> and saves it as a binary dataset <out>,\n"
+            << "                which can be played later without any parsing.\n"
+            << "  While racing, type and press enter:\n"
+            << "      >         Jumps 5% of the race ahead.\n"
+            << "      <         Jumps 5% of the race back.\n"
+            << "      g <time>  Jumps to the first chart stamped <time> or later.\n"
+            << "      q         Quits.\n"
+            << "  Seeking is not available with --stream.\n";
         std::cerr << '\n';
         exit(msg != "" ? 1 : 0);
     }
@@ -79,6 +101,14 @@ namespace bcra
         m_opt.input_filename = "";
         m_opt.fps = global_cfg.default_fps;
         m_opt.n_bars = global_cfg.default_bars;
+        m_opt.tweens = global_cfg.default_tweens;
+        m_opt.threads = 0;
+        m_opt.stream = false;
+        m_opt.diff = true;
+        m_opt.bench = false;
+        m_opt.decimals_given = false;
+        m_opt.palette = palette_e::XTERM256;
+        m_barChart.set_scratch(&m_arena);
     }
 
     /// Initializes the animation engine.
@@ -88,7 +118,7 @@ namespace bcra
 
         // Traverse the list of incoming arguments sent via command line.
         
-        for (auto i{ 0 }; i < argc; ++i) 
+        for (auto i{ 1 }; i < argc; ++i)
         {
 
             std::string param{ argv[i] }; // Convert current argumento into string form for convenience.
@@ -133,6 +163,94 @@ namespace bcra
                 
             }
 
+            else if (param == "-t")
+            {
+                if (i + 1 == argc)
+                    usage("Faltou argumento para -t");
+                int tweens{ 0 };
+                try { tweens = std::stoi(argv[++i]); }
+                catch (const std::exception& e) {
+                    usage("Qtd de quadros intermediarios invalida.");
+                }
+                if (tweens < 0 || tweens > global_cfg.max_tweens)
+                    usage("Qtd de quadros intermediarios fora da faixa. Tente algo em [0,60].");
+                m_opt.tweens = tweens;
+            }
+            else if (param == "-j")
+            {
+                if (i + 1 == argc)
+                    usage("Faltou argumento para -j");
+                int threads{ 0 };
+                try { threads = std::stoi(argv[++i]); }
+                catch (const std::exception& e) {
+                    usage("Qtd de threads invalida.");
+                }
+                if (threads < 0)
+                    usage("Qtd de threads invalida. Use 0 para uma thread por nucleo.");
+                m_opt.threads = threads;
+            }
+            else if (param == "--stream")
+            {
+                m_opt.stream = true;
+            }
+            else if (param == "--no-diff")
+            {
+                m_opt.diff = false;
+            }
+            else if (param == "--bench")
+            {
+                m_opt.bench = true;
+            }
+            else if (param == "--thousands" || param == "--decimal-point")
+            {
+                if (i + 1 == argc)
+                    usage("Faltou argumento para " + param);
+                const std::string sep{ argv[++i] };
+                if (sep.size() != 1 || std::isdigit(static_cast<unsigned char>(sep[0])) || sep[0] == '-' || sep[0] == '+')
+                    usage("Separador invalido para " + param + ": '" + sep + "'. Use um unico caractere.");
+                (param == "--thousands" ? m_opt.value_format.thousands : m_opt.value_format.decimal_point) = sep[0];
+            }
+            else if (param == "--decimals")
+            {
+                if (i + 1 == argc)
+                    usage("Faltou argumento para --decimals");
+                int decimals{ 0 };
+                try { decimals = std::stoi(argv[++i]); }
+                catch (const std::exception& e) {
+                    usage("Qtd de casas decimais invalida.");
+                }
+                if (decimals < 0 || decimals > static_cast<int>(ValueFormat::max_decimals))
+                    usage("Qtd de casas decimais fora da faixa. Tente algo em [0,9].");
+                m_opt.value_format.decimals = static_cast<unsigned>(decimals);
+                m_opt.decimals_given = true;
+            }
+            else if (param == "--colors")
+            {
+                if (i + 1 == argc)
+                    usage("Faltou argumento para --colors");
+                const std::string palette{ argv[++i] };
+                if (palette == "16")
+                    m_opt.palette = palette_e::BASIC;
+                else if (palette == "256")
+                    m_opt.palette = palette_e::XTERM256;
+                else if (palette == "truecolor")
+                    m_opt.palette = palette_e::TRUECOLOR;
+                else
+                    usage("Paleta invalida: '" + palette + "'. Use 16, 256 ou truecolor.");
+            }
+            else if (param == "--from" || param == "--to")
+            {
+                if (i + 1 == argc)
+                    usage("Faltou argumento para " + param);
+                (param == "--from" ? m_opt.from : m_opt.to) = argv[++i];
+            }
+            else if (param == "--compile")
+            {
+                if (i + 2 >= argc)
+                    usage("--compile precisa do arquivo de entrada e do arquivo de saida.");
+                m_opt.input_filename = argv[++i];
+                m_opt.compile_to = argv[++i];
+            }
             else if (param == "-h" || param == "--help") {
                 // Basic help here
                 usage();
@@ -150,88 +268,345 @@ namespace bcra
         // Set the initial animation state.
         m_animation_state = ani_state_e::START;
 
-        std::ifstream file("data\\mossoro.txt"); // => data\\mossoro.txt m_opt.input_filename
-        std::string str;
+        if (m_opt.input_filename.empty())
+            usage("Faltou o arquivo de entrada.");
+        if (m_opt.value_format.thousands == m_opt.value_format.decimal_point)
+            usage("O separador de milhares e o ponto decimal precisam ser diferentes.");
+        // Posicionar o cursor so faz sentido num terminal; arquivos e pipes recebem os quadros completos.
+        m_opt.diff = m_opt.diff && (m_opt.bench || stdout_is_terminal());
+        m_clock.set_rate(double(m_opt.fps) * (m_opt.tweens + 1));
+        m_colors.reset(m_opt.palette);
+
+        auto t_start = std::chrono::steady_clock::now();
+
+        // O arquivo inteiro e mapeado em memoria e lido no lugar, sem copiar linhas.
+        MappedFile file;
+        if (!file.open(m_opt.input_filename))
+            coms::Error(file.error());
+        m_load_stats.bytes = file.size();
+
+        RecordLayout layout;
+        layout.date_idx = global_cfg.input_date_idx;
+        layout.label_idx = global_cfg.input_label_idx;
+        layout.value_idx = global_cfg.input_value_idx;
+        layout.category_idx = global_cfg.input_categoy_idx;
+        layout.value_format = m_opt.value_format;
+
+        DatasetHeader header;
+        LoadReport report;
+        std::string header_lines[3];
+        if (bcrb::is_binary(file.view()))
+        {
+            // Arquivo pre-compilado: as colunas sao usadas direto do mapeamento, sem parsing.
+            // (Ja e lido sob demanda pelo SO, entao o modo --stream nao se aplica.)
+            std::string error;
+            unsigned decimals{ 0 };
+            if (!bcrb::load(std::move(file), header, decimals, m_frames, error))
+                coms::Error(error + ": " + m_opt.input_filename);
+            // Os valores ja estao em ponto fixo: vale a escala gravada no arquivo.
+            if (m_opt.decimals_given && decimals != m_opt.value_format.decimals)
+                coms::Error("--decimals " + std::to_string(m_opt.value_format.decimals) + " nao confere com as "
+                            + std::to_string(decimals) + " casas decimais de " + m_opt.input_filename);
+            m_opt.value_format.decimals = decimals;
+            m_load_stats.binary = true;
+            m_opt.stream = false;
+        }
+        else if (m_opt.stream && m_opt.compile_to.empty())
+        {
+            // Modo streaming: uma thread le os graficos enquanto a animacao roda.
+            file.close();
+            std::string error;
+            if (!m_stream.open(m_opt.input_filename, layout, header_lines, error))
+                coms::Error(error);
+            header.title = header_lines[0];
+            header.value_label = header_lines[1];
+            header.source = header_lines[2];
+        }
+        else
+        {
+            m_opt.stream = false;
+            DatasetReader reader{ file.view() };
+            if (!reader.read_header(header))
+                coms::Error("Arquivo de entrada sem cabecalho: " + m_opt.input_filename);
 
-        if (!file.is_open()) {
-            std::cout << "Saiu com erro! \n";    
-            exit(EXIT_FAILURE);
+            // Cada linha com a quantidade de registros abre um novo grafico.
+            report = load_records(file.view().substr(reader.offset()), layout, m_frames, m_opt.threads);
         }
 
-        std::string push_inicial_dates;
+        m_barChart.main_title = header.title;
+        m_barChart.info_date = header.value_label;
+        m_barChart.fonte_date = header.source;
 
-        getline(file, push_inicial_dates);
-        m_barChart.main_title = push_inicial_dates;
+        m_load_stats.records = m_frames.records();
+        m_load_stats.threads = report.threads;
+        m_load_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
 
-        getline(file, push_inicial_dates);
-        m_barChart.info_date = push_inicial_dates;
+        if (!m_opt.compile_to.empty())
+        {
+            // Modo --compile: grava o arquivo binario e encerra sem animar.
+            std::string error;
+            if (!bcrb::save(m_opt.compile_to, header, m_opt.value_format.decimals, m_frames, error))
+                coms::Error(error);
+            coms::Message("Compiled " + std::to_string(m_frames.records()) + " records in "
+                          + std::to_string(m_frames.frames()) + " charts into " + m_opt.compile_to);
+            m_animation_state = ani_state_e::END;
+            return;
+        }
+        file.close();
 
-        getline(file, push_inicial_dates);
-        m_barChart.fonte_date = push_inicial_dates;
-        getline(file, push_inicial_dates);
-        getline(file, push_inicial_dates);
-        num_linha_por_blocos = stoi(push_inicial_dates);
-        contador_charts = 0;
+        if (report.malformed > 0)
+            coms::Warning(std::to_string(report.malformed) + " linha(s) mal formada(s) ignorada(s) em " + m_opt.input_filename);
 
-        while (getline(file, str))
+        m_current_frame = 0;
+        if (!m_opt.stream)
         {
-            // tentei o stoi mas nao deu muito certo => error: stoi what()
-            if ((str.size() < 2))
-            {
+            m_index.build(m_frames);
+            select_range();
+            m_current_frame = m_first_frame;
+        }
+        if (!fetch_frame())
+            coms::Error(m_opt.from.empty() && m_opt.to.empty()
+                        ? "Nenhum registro encontrado em " + m_opt.input_filename
+                        : "Nenhum grafico entre --from e --to em " + m_opt.input_filename);
 
-                contador_charts+=1;
-                getline(file, str);
-            }
-            else
-            {
-                std::vector<std::string> aux;   //vector auxiliar
+        if (m_opt.bench)
+        {
+            // Sem terminal, sem pausas e sem threads: so mede a corrida.
+            run_bench();
+            m_animation_state = ani_state_e::END;
+            return;
+        }
 
-                aux = split(str, ',');
+        // Entrada, simulacao (esta thread) e saida rodam em paralelo.
+        // A largura do terminal e lida uma vez: linhas mais longas quebrariam e estragariam o diff.
+        m_renderer.start(m_opt.diff, global_cfg.height, global_cfg.width, terminal_columns());
+        m_input.start();
+    }
 
-                m_barChart.bars.push_back ( BarChart::BarItem{ aux[1], stoi(aux[3]), aux[4] });
+    /// Moves the race one screen frame ahead: the next in-between frame or the next chart.
+    /*!
+     * A pending seek takes the place of the step, so that the chosen frame is shown.
+     * @param times If not null, receives the time spent fetching and ranking.
+     * @return false when there are no more charts.
+     */
+    bool BCRAnimation::advance_frame(StepTimes * times)
+    {
+        using clock = std::chrono::steady_clock;
+        if (m_seeked)
+        {
+            m_seeked = false;
+            return true;
+        }
+        const auto t0 = times ? clock::now() : clock::time_point{};
+        if (m_tween_step < m_opt.tweens)
+        {
+            m_tween_step += 1;
+            m_tween.step(float(m_tween_step + 1) / (m_opt.tweens + 1));
+            if (times)
+                times->rank += clock::now() - t0;
+            return true;
+        }
+        m_current_frame += 1;
+        const bool more = load_frame();
+        const auto t1 = times ? clock::now() : t0;
+        if (times)
+            times->fetch += t1 - t0;
+        if (!more)
+            return false;
+        rank_frame();
+        if (times)
+        {
+            times->rank += clock::now() - t1;
+            times->charts += 1;
+        }
+        return true;
+    }
 
-                for (auto i : aux)              // push back no vector aux
-                    files.push_back(i);
-        
+    /// Finds the frames between --from and --to (the whole race by default) in the index.
+    void BCRAnimation::select_range()
+    {
+        m_first_frame = 0;
+        m_end_frame = m_frames.frames();
+        if (!m_opt.from.empty())
+            m_first_frame = m_index.first_at_or_after(m_opt.from);
+        if (!m_opt.to.empty())
+            m_end_frame = m_index.end_at_or_before(m_opt.to);
+        // Fora de ordem, o indice so acha marcas exatas; com marcas numericas, so aceita numeros.
+        if (m_first_frame == FrameIndex::npos || m_end_frame == FrameIndex::npos)
+            coms::Error(std::string(m_index.ordered() ? "Marca de tempo invalida (as do arquivo sao numeros): "
+                                                      : "Marca de tempo nao encontrada (as do arquivo estao fora de ordem, use uma que exista): ")
+                        + (m_first_frame == FrameIndex::npos ? m_opt.from : m_opt.to));
+        if (m_first_frame >= m_end_frame)
+            coms::Error("Nenhum grafico entre --from e --to em " + m_opt.input_filename);
+    }
 
-                if (cores.size() == 0)
-                {
-                    //std::cout << "entrei " << std::endl;
-                    cores.push_back(files.back());
-                }
-                else if (cores.size() >= 1)
-                {
-                    //std::cout << files.back() << std::endl;
-                    if (test_cor(cores, files.back())) {cores.push_back(files.back());}
-                }
+    /// Jumps to `frame`, kept inside the --from/--to range. The bars slide from what is on screen.
+    void BCRAnimation::seek(std::size_t frame)
+    {
+        m_current_frame = std::clamp(frame, m_first_frame, m_end_frame - 1);
+        // A ordem do grafico anterior nao ajuda depois de um salto.
+        m_barChart.reset_rank();
+        fetch_frame();
+        m_seeked = true;
+    }
+
+    /// Reacts to a command typed during the race.
+    void BCRAnimation::handle_input(const InputEvent & event)
+    {
+        if (event.type == input_e::QUIT)
+        {
+            m_animation_state = ani_state_e::END;
+            return;
+        }
+        // Sem indice no modo streaming: nao da para pular.
+        if (m_opt.stream)
+            return;
+        const std::size_t jump = std::max<std::size_t>(1, (m_end_frame - m_first_frame) / 20);
+        if (event.type == input_e::FORWARD)
+            seek(m_current_frame + jump);
+        else if (event.type == input_e::BACK)
+            seek(m_current_frame - std::min(jump, m_current_frame));
+        else if (event.type == input_e::SEEK)
+        {
+            const auto frame = m_index.first_at_or_after(event.time_stamp);
+            if (frame != FrameIndex::npos)
+                seek(frame);
+        }
+    }
+
+    /// Loads frame `m_current_frame` into the bar chart, sorted.
+    /*!
+     * @return false if there is no such frame (the chart is left untouched).
+     */
+    bool BCRAnimation::fetch_frame()
+    {
+        if (!load_frame())
+            return false;
+        rank_frame();
+        return true;
+    }
+
+    /// Fills the bar chart with frame `m_current_frame`.
+    /*!
+     * @return false if there is no such frame.
+     */
+    bool BCRAnimation::load_frame()
+    {
+        if (m_opt.stream)
+        {
+            // Sem indice: os graficos antes de --from sao lidos e descartados.
+            while (m_stream.next(m_barChart))
+            {
+                if (!m_opt.from.empty() && compare_time(m_barChart.time_stamp, m_opt.from) < 0)
+                    continue;
+                return m_opt.to.empty() || compare_time(m_barChart.time_stamp, m_opt.to) <= 0;
             }
+            return false;
         }
-        file.close();
 
-        contador_charts = contador_charts; 
-        
-        // perceba que o contador na vdd soma dois no if
-        // e estou somando mais 1 pois existe o ultimo else a ser lido, logo tem mais 1 chart.
+        if (m_current_frame >= m_end_frame)
+            return false;
+        const auto & label_ids = m_frames.label_ids();
+        const auto & values = m_frames.values();
+        const auto & category_ids = m_frames.category_ids();
+
+        const auto first = m_frames.begin(m_current_frame);
+        m_barChart.assign(label_ids.data() + first, values.data() + first, category_ids.data() + first,
+                          m_frames.end(m_current_frame) - first);
+        m_barChart.time_stamp = m_frames.frame_time(m_current_frame);
+        return true;
+    }
 
-         
+    /// Ranks the chart just loaded and starts the transition into it.
+    void BCRAnimation::rank_frame()
+    {
+        // Frames seguidos mudam pouco: reaproveita a ordem do grafico anterior.
+        m_barChart.rerank(m_opt.n_bars);
+        update_colors();
+        // A transicao parte do que esta na tela; o primeiro quadro dela ja e desenhado.
+        m_tween.retarget(m_barChart, m_opt.n_bars);
+        m_tween_step = 0;
+        m_tween.step(1.0f / (m_opt.tweens + 1));
+    }
 
-        for (int i = 0; i < cores.size(); i++)
+    /// Plays the whole race headless, as fast as possible, timing each stage of a frame.
+    void BCRAnimation::run_bench()
+    {
+        using clock = std::chrono::steady_clock;
+        // Estagios de um quadro: fetch (grafico lido do store/stream), rank (ordenacao e transicao),
+        // layout (texto do quadro), encode (diferenca com a tela anterior) e write (dispositivo nulo).
+        StepTimes steps;
+        clock::duration t_layout{}, t_encode{}, t_write{};
+        std::size_t frames{ 0 }, bytes_in{ 0 }, bytes_out{ 0 };
+        FrameBuffer frame, encoded;
+        DiffScreen screen{ global_cfg.height, global_cfg.width };
+        const int sink = open_null_output();
+        if (sink < 0)
+            coms::Error("nao foi possivel abrir o dispositivo nulo");
+
+        const auto t_begin = clock::now();
+        const auto allocs_begin = allocation_count();
+        auto allocs_warm = allocs_begin;
+        for (;;)
         {
-            //std::cout << cores[i] << std::endl;
-            //if (i >= 13)
-              //  Pairs.insert(MID::value_type(Color::tcolor(cores[0], Color::color_list[0]), Color::tcolor("█", Color::color_list[0])));
-            //else 
-                Pairs.insert(std::pair<std::string, std::string>((Color::tcolor(cores[i], Color::color_list[i])), 
-                                                            (Color::tcolor("█", Color::color_list[i]))));
-            
+            if (frames == 1)
+                allocs_warm = allocation_count(); // O primeiro quadro aquece buffers e tabelas.
+            const auto t0 = clock::now();
+            compose_racing(frame);
+            const auto t1 = clock::now();
+            bytes_in += frame.size();
+            auto * out = &frame;
+            if (m_opt.diff)
+            {
+                screen.render(frame.view(), encoded);
+                frame.clear();
+                out = &encoded;
+            }
+            const auto t2 = clock::now();
+            bytes_out += out->size();
+            out->write_to(sink);
+            const auto t3 = clock::now();
+            t_layout += t1 - t0;
+            t_encode += t2 - t1;
+            t_write += t3 - t2;
+            ++frames;
+            m_arena.reset();
+            if (!advance_frame(&steps))
+                break;
         }
-        
-        
+        const double seconds = std::chrono::duration<double>(clock::now() - t_begin).count();
+        const auto allocs_end = allocation_count();
+        close_output(sink);
+
+        auto per_frame = [frames](clock::duration d) {
+            return std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / static_cast<long long>(frames));
+        };
+        coms::Message("Benchmark: " + m_opt.input_filename);
+        if (!m_opt.stream)
+            coms::Message(std::string(m_load_stats.binary ? "Map: " : "Parse: ") + fixed(m_load_stats.seconds * 1000.0)
+                          + " ms, " + std::to_string(m_load_stats.records) + " records ("
+                          + fixed(m_load_stats.bytes_per_second() / (1024.0 * 1024.0)) + " MB/s, "
+                          + std::to_string(m_load_stats.threads) + " thread(s))");
+        coms::Message("Race: " + std::to_string(steps.charts + 1) + " charts, " + std::to_string(frames) + " frames in "
+                      + fixed(seconds * 1000.0) + " ms (" + fixed(frames / seconds) + " frames/s)");
+        coms::Message("ns/frame: fetch " + per_frame(steps.fetch) + ", rank " + per_frame(steps.rank) + ", layout "
+                      + per_frame(t_layout) + ", encode " + per_frame(t_encode) + ", write " + per_frame(t_write)
+                      + " (total " + per_frame(steps.fetch + steps.rank + t_layout + t_encode + t_write) + ")");
+        coms::Message("Output: " + std::to_string(bytes_in / frames) + " bytes/frame composed, "
+                      + std::to_string(bytes_out / frames) + " bytes/frame written");
+        coms::Message("Heap: " + std::to_string(allocs_end - allocs_begin) + " allocations while racing, "
+                      + std::to_string(allocs_end - allocs_warm) + " after the first frame (frame arena: peak "
+                      + std::to_string(m_arena.peak()) + " bytes, " + std::to_string(m_arena.refills()) + " block(s))");
+        coms::Message("Peak RSS: " + fixed(peak_rss_bytes() / (1024.0 * 1024.0)) + " MB");
+    }
 
-        indice_time = 0;
-        count_value = 0;
-        m_barChart.time_stamp = files[indice_time];
-        
+    /// Gives a color to every category that does not have one yet.
+    void BCRAnimation::update_colors()
+    {
+        // Cada categoria nova ganha o proximo slot de cor (no modo streaming, elas vao aparecendo aos poucos).
+        const auto & categories = interned().categories;
+        for (auto id = static_cast<str_id_t>(m_colors.size()); id < categories.size(); ++id)
+            m_colors.add(id);
     }
 
 
@@ -257,7 +632,10 @@ namespace bcra
         }
         else if (m_animation_state == ani_state_e::RACING)
         {
-          
+            // Nunca espera: so consome o que a thread de entrada ja leu.
+            InputEvent event;
+            while (m_animation_state == ani_state_e::RACING && m_input.poll(event))
+                handle_input(event);
         }
         else if (m_animation_state == ani_state_e::END)
         {
@@ -284,22 +662,22 @@ namespace bcra
         {
             // leitura dos dados (pode ser antes do welcome ?)
             m_animation_state = ani_state_e::RACING;
+            m_clock.start();
         }
         else if (m_animation_state == ani_state_e::RACING)
         {
-            std::chrono::milliseconds  duration{ 1000 / m_opt.fps };
-            std::this_thread::sleep_for(duration);
-
-            if ((indice_time + (num_linha_por_blocos * 5))  < files.size())
+            // Os quadros tem horario marcado; se estivermos atrasados, os perdidos sao descartados
+            // (a animacao avanca varios passos e so o ultimo e desenhado).
+            for (auto steps = m_clock.wait(); steps > 0; --steps)
             {
-                indice_time +=  (num_linha_por_blocos * 5);
-                count_value += m_opt.n_bars;
-                m_barChart.time_stamp = files[indice_time];
-            } else {
-            m_animation_state = ani_state_e::END;
+                if (m_clock.frames() == 2 && m_race_allocs == 0)
+                    m_race_allocs = allocation_count(); // O primeiro quadro ja foi desenhado.
+                if (!advance_frame())
+                {
+                    m_animation_state = ani_state_e::END;
+                    break;
+                }
             }
-
-            
         }
         else if (m_animation_state == ani_state_e::END)
         {
@@ -333,38 +711,54 @@ namespace bcra
         {
             // 
         }
+        // O que o quadro alocou de rascunho ja nao e usado.
+        m_arena.reset();
     }
 
     void BCRAnimation::print_racing(void) const
     {
-        std::cout << Color::tcolor(m_barChart.main_title, Color::BLUE, Color::BOLD)  << std::endl;
-        std::cout << std::endl;
-        std::cout << "Time Stamp: " << Color::tcolor(m_barChart.time_stamp, Color::BLUE, Color::BOLD) << std::endl;
+        // O quadro e montado num buffer e escrito pela thread de renderizacao.
+        // Se o terminal estiver atrasado (nenhum buffer livre), este quadro nao e desenhado.
+        auto * frame = m_renderer.acquire();
+        if (frame == nullptr)
+            return;
+        compose_racing(*frame);
+        m_renderer.submit(frame);
+    }
 
-        //
-        int j = 70; // é um ma
-        MID::const_iterator iter2 = Pairs.begin();
-        for (auto i{ 0 }; i < Pairs.size(); ++i)
+    /// Appends the racing screen to `out`.
+    void BCRAnimation::compose_racing(FrameBuffer & out) const
+    {
+        Color::append(out, m_barChart.main_title, Color::BLUE, Color::BOLD).append("\n\n");
+        Color::append(out.append("Time Stamp: "), m_barChart.time_stamp, Color::BLUE, Color::BOLD).append("\n");
+
+        // O maior valor ocupa Cfg::max_bar_length caracteres; as outras barras sao proporcionais,
+        // com resolucao de 1/8 de caractere.
+        // Valores visiveis num vetor so: maximo e larguras saem de dois lacos vetorizados.
+        const auto & labels = interned().labels;
+        const std::size_t n_rows = std::min<std::size_t>(m_tween.size(), Cfg::max_bars);
+        std::array<value_t, Cfg::max_bars> values;
+        std::array<std::uint32_t, Cfg::max_bars> widths;
+        for (std::size_t i{ 0 }; i < n_rows; ++i)
+            values[i] = m_tween.row(i).value;
+        const auto max_value = value_stats(values.data(), n_rows).max;
+        bar_widths(values.data(), n_rows, std::max<value_t>(max_value, 0), global_cfg.max_bar_length, widths.data());
+        for (std::size_t i{ 0 }; i < n_rows; ++i)
         {
-
-            for (auto k{ 0 }; k < j; ++k)
-            {
-                std::cout << iter2->second;
-            }
-            std::cout << " " << m_barChart.bars[i + count_value].category << "[" << m_barChart.bars[i + count_value].value << "]\n\n";
-            iter2++;
-            j -= 5;
+            const auto bar = m_tween.row(i);
+            out.append(m_colors.sgr(bar.category));
+            out.append_bar(widths[i]);
+            out.append(Color::reset);
+            out.append(" ").append(labels[bar.label]).append("[").append_fixed(bar.value, m_opt.value_format.decimals).append("]\n\n");
         }
-        std::cout << "\n";
+        out.append("\n");
         //
-        std::cout << "+"; linha(90, '-'); std::cout << ">\n";
-        std::cout << Color::tcolor(m_barChart.info_date, Color::BLUE, Color::BOLD) << "\n";
-        std::cout << "\n\n";
-        std::cout << Color::tcolor(m_barChart.fonte_date, Color::BLUE, Color::BOLD) << "\n";
-        for (auto i : Pairs)
-            std::cout << i.second << ": " << i.first << " ";
-        std::cout << "\n\n";
-       
+        out.append("+").append(global_cfg.max_bar_length, '-').append(">\n");
+        Color::append(out, m_barChart.info_date, Color::BLUE, Color::BOLD).append("\n");
+        out.append("\n\n");
+        Color::append(out, m_barChart.fonte_date, Color::BLUE, Color::BOLD).append("\n");
+        print_legend(out);
+        out.append("\n\n");
     }
 
     void BCRAnimation::print_welcome(void) const
@@ -376,32 +770,69 @@ namespace bcra
         coms::Message("Preparing to read input file " + m_opt.input_filename);
         std::cout << std::endl;
         coms::Message("Processing data, please wait.");
-        coms::Message("Input file sucessfuly read.\n");
-        coms::Message("We have \"" + std::to_string(contador_charts) + "\" Charts, each with \"" + std::to_string(m_opt.n_bars) + "\" bars\n");
+        coms::Message("Input file sucessfuly read.");
+        if (!m_opt.stream)
+            coms::Message(std::string(m_load_stats.binary ? "Mapped binary dataset: " : "Read ")
+                          + std::to_string(m_load_stats.bytes) + " bytes, " + std::to_string(m_load_stats.records)
+                          + " records in " + std::to_string(m_load_stats.seconds * 1000.0) + " ms ("
+                          + std::to_string(m_load_stats.bytes_per_second() / (1024.0 * 1024.0)) + " MB/s, "
+                          + std::to_string(m_load_stats.threads) + " thread(s))\n");
+        if (m_opt.stream)
+            coms::Message("Streaming charts while playing, each with \"" + std::to_string(m_opt.n_bars) + "\" bars\n");
+        else
+            coms::Message("We have \"" + std::to_string(m_frames.frames()) + "\" Charts, each with \"" + std::to_string(m_opt.n_bars) + "\" bars\n");
         coms::Message("Animation speed is: " + std::to_string(m_opt.fps));
         coms::Message("Title: " + m_barChart.main_title);
         coms::Message("Value is: " + m_barChart.info_date);
         coms::Message("Source : " + m_barChart.fonte_date);
-        coms::Message("# of categories found: " + std::to_string(cores.size()));
+        coms::Message("# of categories found: " + std::to_string(interned().categories.size()));
+        if (!m_opt.stream)
+            coms::Message("While racing, type '>' or '<' to jump ahead or back, 'g <time>' to go to a time stamp, and 'q' to quit.");
         coms::Message("Press enter to begin the animation.\n");
 
         
-        for (auto i : Pairs)
-            std::cout << i.first ; 
+        std::string names;
+        for (std::size_t slot{ 0 }; slot < m_colors.size(); ++slot)
+        {
+            const auto id = m_colors.slot_category(static_cast<std::uint32_t>(slot));
+            m_colors.append(names, interned().categories[id], id);
+        }
+        std::cout << names;
 
     }
 
     void BCRAnimation::print_end(void) const
     {
-        std::cout << Color::tcolor(m_barChart.time_stamp, Color::BLUE, Color::BOLD) << "\n";
-        std::cout << "\n\n\n\n";
-        std::cout << Color::tcolor(m_barChart.info_date, Color::BLUE, Color::BOLD) << "\n";
-        std::cout << "\n\n";
-        std::cout << Color::tcolor(m_barChart.fonte_date, Color::BLUE, Color::BOLD) << "\n";
-        for (auto i : Pairs)
-            std::cout << i.second << ": " << i.first << " ";
-        std::cout << "\n\n";
-        std::cout << "Hope you have enjoyed the Bar Chart Race!\n";
+        const auto race_allocs = allocation_count() - m_race_allocs; // Antes das mensagens abaixo.
+        auto * frame = m_renderer.acquire(true);
+        auto & out = *frame;
+        Color::append(out, m_barChart.time_stamp, Color::BLUE, Color::BOLD).append("\n");
+        out.append("\n\n\n\n");
+        Color::append(out, m_barChart.info_date, Color::BLUE, Color::BOLD).append("\n");
+        out.append("\n\n");
+        Color::append(out, m_barChart.fonte_date, Color::BLUE, Color::BOLD).append("\n");
+        print_legend(out);
+        out.append("\n\n");
+        out.append("Hope you have enjoyed the Bar Chart Race!\n");
+        m_renderer.submit(frame);
+        m_renderer.drain(); // As mensagens abaixo vao direto para o std::cout.
+        if (m_clock.frames() > 1)
+        {
+            coms::Message("Playback: " + std::to_string(m_clock.frames()) + " frames at " + fixed(m_clock.achieved_fps())
+                          + " fps (target " + fixed(m_clock.target_fps()) + "), " + std::to_string(m_clock.dropped()) + " dropped, "
+                          + std::to_string(m_renderer.skipped()) + " skipped by a slow terminal");
+            coms::Message("Frame time (ms): p50 " + fixed(m_clock.percentile(50)) + ", p90 " + fixed(m_clock.percentile(90))
+                          + ", p99 " + fixed(m_clock.percentile(99)) + ", max " + fixed(m_clock.max_frame_ms()));
+        }
+        if (m_race_allocs > 0)
+            coms::Message("Heap: " + std::to_string(race_allocs)
+                          + " allocations after the first frame (all threads)");
+        const auto & screen = m_renderer.screen();
+        if (m_opt.diff && screen.bytes_in() > 0)
+            coms::Message("Terminal output: " + std::to_string(screen.bytes_out()) + " bytes ("
+                          + std::to_string(screen.bytes_in()) + " without diffing)");
+        if (m_opt.stream && m_stream.malformed() > 0)
+            coms::Warning(std::to_string(m_stream.malformed()) + " linha(s) mal formada(s) ignorada(s) em " + m_opt.input_filename);
     }
     
     bool BCRAnimation::search_binary(std::vector<std::string>::iterator it_init, std::vector<std::string>::iterator it_fim, const std::string word)
@@ -414,26 +845,22 @@ namespace bcra
         return false;
     }
 
-    bool BCRAnimation::test_cor(const std::vector<std::string> test, const std::string word)
+    /// Prints the color of each category.
+    void BCRAnimation::print_legend(FrameBuffer & out) const
     {
-        for(auto i {0}; i < test.size(); ++i)
+        const auto & categories = interned().categories;
+        for (std::size_t slot{ 0 }; slot < m_colors.size(); ++slot)
         {
-            if(test[i] == word)
-                return false;
+            const auto id = m_colors.slot_category(static_cast<std::uint32_t>(slot));
+            m_colors.append(out, "█", id).append(": ");
+            m_colors.append(out, categories[id], id).append(" ");
         }
-        return true;
-    }
-    void BCRAnimation::press_enter(void)
-    {
-        //getchar();
-        std::cin.ignore();
     }
 
-    void BCRAnimation::linha(int a, char b) const
+    void BCRAnimation::press_enter(void)
     {
-        for (auto i = 0; i < a; i++)
-        {
-            std::cout << b;
-        }
+        // Enter (ou o fim da entrada) comeca a corrida; 'q' sai.
+        if (m_input.wait().type == input_e::QUIT)
+            m_animation_state = ani_state_e::END;
     }
 };
@@ -9,6 +9,7 @@
 #include <thread>
 #include <memory>
 #include <algorithm>
+#include <chrono>
 #include <vector>
 using std::vector;
 #include <iterator>
@@ -17,21 +18,24 @@ using std::ostringstream;
 #include <numeric>
 #include <string>
 using std::string;
+#include <string_view>
 
 #include <thread>
 
 #include "../libs/text_color.h"
 #include "barchart.h"
+#include "color_registry.h"
+#include "frame_arena.h"
+#include "frame_index.h"
+#include "frame_store.h"
+#include "frame_clock.h"
+#include "frame_stream.h"
+#include "input_thread.h"
+#include "render_thread.h"
+#include "tween.h"
 #include "types.h" // uint
 
-#include <map>
-
-typedef std::map <std::string, std::string> MID;
-
 namespace bcra {
-    //== Helper functions
-    std::vector<std::string> split(const std::string & input_str, char delimiter = ' ');
-
     // TODO: Future feature: read this configuration from a file.
     /// This struct holds some defaults values.
     struct Cfg {
@@ -39,6 +43,8 @@ namespace bcra {
         static constexpr short max_bars = 15;         //!< Max number of bars allowed in the animation.
         static constexpr short default_fps = 5;      //!< Default fps.
         static constexpr short max_fps = 45;          //!< Max fps allowed.
+        static constexpr short default_tweens = 0;    //!< Default # of in-between frames.
+        static constexpr short max_tweens = 60;       //!< Max # of in-between frames per chart.
 
         static constexpr short max_bar_length = 50;   //!< Max bar length in characters units.
         static constexpr short n_ticks = 5;           //!< Number of ticks on the X axis.
@@ -72,6 +78,35 @@ namespace bcra {
                 std::string input_filename; //!< Input data file.
                 short n_bars;               //!< Requested # of bars per chart.
                 short fps;                  //!< Animation speed in frames per second.
+                short tweens;               //!< # of in-between frames drawn between two charts.
+                unsigned threads;           //!< # of threads to read the input (0 = one per core).
+                std::string compile_to;     //!< Output of --compile; empty when animating.
+                bool stream;                //!< Read the frames while playing instead of up front.
+                bool diff;                  //!< Repaint only the cells that changed (off with --no-diff).
+                bool bench;                 //!< Play headless, as fast as possible, and report timings.
+                palette_e palette;          //!< Colors of the categories past the basic ones.
+                ValueFormat value_format;   //!< How the values are written in the input.
+                bool decimals_given;        //!< --decimals was on the command line.
+                std::string from;           //!< First time stamp played (--from); empty means the start.
+                std::string to;             //!< Last time stamp played (--to); empty means the end.
+            };
+
+            /// Time spent by `advance_frame()` in each stage, accumulated for --bench.
+            struct StepTimes {
+                std::chrono::steady_clock::duration fetch{}; //!< Reading the next chart.
+                std::chrono::steady_clock::duration rank{};  //!< Ranking it and stepping the transition.
+                std::size_t charts = 0;                      //!< # of charts fetched.
+            };
+
+            /// Statistics of the last input file load.
+            struct LoadStats {
+                std::size_t bytes = 0;   //!< Size of the input file.
+                std::size_t records = 0; //!< # of data records kept.
+                unsigned threads = 1;    //!< # of threads that parsed the file.
+                bool binary = false;     //!< True if the input was a precompiled .bcrb file.
+                double seconds = 0.0;    //!< Wall time spent loading.
+                /// Loading throughput.
+                double bytes_per_second( void ) const { return seconds > 0.0 ? bytes / seconds : 0.0; }
             };
 
             //=== Data members
@@ -79,19 +114,23 @@ namespace bcra {
             static Cfg m_cfg;              //!< Overall default values for the options and other stuff.
             ani_state_e m_animation_state; //!< Current animation state.
             std::string m_error_msg;       //!< Current error message.
+            LoadStats m_load_stats;        //!< How long it took to read the input file.
             BarChart m_barChart;
-            MID Pairs;
-            MID Pairs2;
-            std::vector<std::string> cores;
-            std::vector<std::string>::iterator inicio;
-            std::vector<std::string>::iterator fim;
-            // TODO: Add your own stuff here
-            short contador_charts;
-            // na vdd eu n uso esse vector, eu uso o do barchart
-            std::vector<std::string> files;
-            short num_linha_por_blocos;
-            int indice_time;
-            int count_value;
+            FrameStore m_frames;           //!< Every bar chart read from the input file.
+            FrameStream m_stream;          //!< Frame source in --stream mode.
+            FrameIndex m_index;            //!< Finds the frames of `m_frames` by time stamp.
+            std::size_t m_current_frame;   //!< Frame being displayed.
+            std::size_t m_first_frame = 0; //!< First frame of the --from/--to range.
+            std::size_t m_end_frame = 0;   //!< One past the last frame of the range.
+            bool m_seeked = false;         //!< A seek already loaded the next frame to show.
+            Tween m_tween;                 //!< What is drawn: the transition into the current frame.
+            short m_tween_step = 0;        //!< In-between frame being displayed, in [0, tweens].
+            FrameClock m_clock;            //!< When each frame of the race is due.
+            ColorRegistry m_colors{ palette_e::XTERM256, Cfg::default_color }; //!< Color of each category.
+            mutable FrameArena m_arena;      //!< Scratch memory of the frame being built; freed after each render().
+            std::uint64_t m_race_allocs = 0; //!< Heap allocations made before the second frame of the race.
+            mutable RenderThread m_renderer; //!< Writes the frames composed by the print_* methods.
+            InputThread m_input;             //!< Keyboard events.
             std::string space = " ";
             
         public:
@@ -116,12 +155,21 @@ namespace bcra {
         private:
             /// Print out the usage instructions.
             void usage( std::string  );
+            bool fetch_frame( void );
+            bool load_frame( void );
+            void rank_frame( void );
+            bool advance_frame( StepTimes * times = nullptr );
+            void select_range( void );
+            void seek( std::size_t frame );
+            void handle_input( const InputEvent & event );
+            void run_bench( void );
+            void compose_racing(FrameBuffer &) const;
+            void update_colors( void );
             void print_welcome(void) const;
             void print_racing(void) const;
             void print_end(void) const;
             void press_enter(void);
-            void linha(int, char) const;
-            bool test_cor(const std::vector<std::string>, const std::string);
+            void print_legend(FrameBuffer &) const;
             bool search_binary(std::vector<std::string>::iterator, std::vector<std::string>::iterator, const std::string);
    
        
@@ -0,0 +1,295 @@
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+#include "bcrb.h"
+
+namespace bcra {
+namespace bcrb {
+
+    namespace {
+        constexpr char magic[4] = { 'B', 'C', 'R', 'B' };
+        constexpr std::uint32_t endian_tag = 0x01020304; //!< Reads differently on a machine with the other byte order.
+        constexpr std::uint64_t alignment = 64;          //!< Every section starts at a multiple of this.
+
+        /// The sections of the file, in file order.
+        enum section_e : std::uint32_t {
+            TITLE = 0,
+            VALUE_LABEL,
+            SOURCE,
+            TIMESTAMPS,
+            LABELS,
+            CATEGORIES,
+            TIME_IDS,
+            LABEL_IDS,
+            VALUES,
+            CATEGORY_IDS,
+            FRAME_OFFSETS,
+            N_SECTIONS
+        };
+
+        struct FileHeader {
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t endian_tag;
+            std::uint32_t n_sections;
+            std::uint64_t n_rows;
+            std::uint64_t n_frames;
+            std::uint32_t decimals; //!< The values are fixed point with this many decimal places.
+            std::uint32_t reserved32;
+            std::uint64_t reserved[3];
+        };
+        static_assert( sizeof( FileHeader ) == 64, "FileHeader must fill exactly one aligned block" );
+
+        struct SectionEntry {
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
+        std::uint64_t align_up( std::uint64_t n ) { return ( n + alignment - 1 ) / alignment * alignment; }
+
+        /// Bytes of a serialized string table.
+        std::uint64_t table_size( const StringTable & table )
+        {
+            std::uint64_t bytes{ sizeof( std::uint64_t ) * ( table.size() + 2 ) };
+            for ( str_id_t id{ 0 }; id < table.size(); ++id ) bytes += table[id].size();
+            return bytes;
+        }
+
+        void write_table( std::ofstream & out, const StringTable & table )
+        {
+            std::uint64_t count{ table.size() };
+            out.write( reinterpret_cast<const char *>( &count ), sizeof( count ) );
+            std::uint64_t offset{ 0 };
+            for ( str_id_t id{ 0 }; id <= table.size(); ++id )
+            {
+                out.write( reinterpret_cast<const char *>( &offset ), sizeof( offset ) );
+                if ( id < table.size() ) offset += table[id].size();
+            }
+            for ( str_id_t id{ 0 }; id < table.size(); ++id )
+                out.write( table[id].data(), table[id].size() );
+        }
+
+        /// Interns every string of a serialized table, checking the ids match the ones in the file.
+        bool read_table( std::string_view bytes, StringTable & table )
+        {
+            std::uint64_t count{ 0 };
+            if ( bytes.size() < sizeof( count ) ) return false;
+            std::memcpy( &count, bytes.data(), sizeof( count ) );
+            const std::uint64_t header = sizeof( std::uint64_t ) * ( count + 2 );
+            if ( count >= StringTable::npos || header > bytes.size() ) return false;
+
+            std::vector< std::uint64_t > offsets( count + 1 );
+            std::memcpy( offsets.data(), bytes.data() + sizeof( count ), offsets.size() * sizeof( std::uint64_t ) );
+            const auto blob = bytes.substr( header );
+            for ( std::uint64_t i{ 0 }; i < count; ++i )
+            {
+                if ( offsets[i] > offsets[i + 1] || offsets[i + 1] > blob.size() ) return false;
+                if ( table.intern( blob.substr( offsets[i], offsets[i + 1] - offsets[i] ) ) != i ) return false;
+            }
+            return true;
+        }
+
+        template < typename T >
+        Column< T > column( const char * base, const SectionEntry & section )
+        {
+            return Column< T >{ reinterpret_cast<const T *>( base + section.offset ), section.size / sizeof( T ) };
+        }
+    }
+
+    bool is_binary( std::string_view data )
+    {
+        return data.size() >= sizeof( magic ) && std::memcmp( data.data(), magic, sizeof( magic ) ) == 0;
+    }
+
+    bool save( const std::string & filename, const DatasetHeader & header, unsigned decimals,
+               const FrameStore & store, std::string & error )
+    {
+        static_assert( std::is_same_v< str_id_t, std::uint32_t >, "ids are stored as u32" );
+        const auto rows = store.records();
+
+        SectionEntry sections[N_SECTIONS];
+        const std::uint64_t sizes[N_SECTIONS] = {
+            header.title.size(), header.value_label.size(), header.source.size(),
+            table_size( store.timestamps() ), table_size( store.labels() ), table_size( store.categories() ),
+            rows * sizeof( std::uint32_t ), rows * sizeof( std::uint32_t ),
+            rows * sizeof( std::int64_t ), rows * sizeof( std::uint32_t ),
+            store.offsets().size() * sizeof( std::uint64_t ) };
+        std::uint64_t offset = align_up( sizeof( FileHeader ) + sizeof( sections ) );
+        for ( std::uint32_t s{ 0 }; s < N_SECTIONS; ++s )
+        {
+            sections[s] = SectionEntry{ offset, sizes[s] };
+            offset = align_up( offset + sizes[s] );
+        }
+
+        FileHeader fh{};
+        std::memcpy( fh.magic, magic, sizeof( magic ) );
+        fh.version = version;
+        fh.endian_tag = endian_tag;
+        fh.n_sections = N_SECTIONS;
+        fh.n_rows = rows;
+        fh.n_frames = store.frames();
+        fh.decimals = decimals;
+
+        std::ofstream out{ filename, std::ios::binary | std::ios::trunc };
+        if ( !out )
+        {
+            error = "nao foi possivel criar \"" + filename + "\"";
+            return false;
+        }
+        out.write( reinterpret_cast<const char *>( &fh ), sizeof( fh ) );
+        out.write( reinterpret_cast<const char *>( sections ), sizeof( sections ) );
+
+        static const char zeros[alignment] = {};
+        auto pad_to = [&]( std::uint64_t pos ) {
+            auto here = static_cast<std::uint64_t>( out.tellp() );
+            if ( pos > here ) out.write( zeros, static_cast<std::streamsize>( pos - here ) );
+        };
+        auto write_ids = [&]( const Column< str_id_t > & col ) {
+            out.write( reinterpret_cast<const char *>( col.data() ), col.size() * sizeof( str_id_t ) );
+        };
+
+        pad_to( sections[TITLE].offset );       out.write( header.title.data(), header.title.size() );
+        pad_to( sections[VALUE_LABEL].offset ); out.write( header.value_label.data(), header.value_label.size() );
+        pad_to( sections[SOURCE].offset );      out.write( header.source.data(), header.source.size() );
+        pad_to( sections[TIMESTAMPS].offset );  write_table( out, store.timestamps() );
+        pad_to( sections[LABELS].offset );      write_table( out, store.labels() );
+        pad_to( sections[CATEGORIES].offset );  write_table( out, store.categories() );
+        pad_to( sections[TIME_IDS].offset );    write_ids( store.time_ids() );
+        pad_to( sections[LABEL_IDS].offset );   write_ids( store.label_ids() );
+        pad_to( sections[VALUES].offset );
+        if constexpr ( sizeof( value_t ) == sizeof( std::int64_t ) )
+            out.write( reinterpret_cast<const char *>( store.values().data() ), rows * sizeof( std::int64_t ) );
+        else
+            for ( auto v : store.values() )
+            {
+                std::int64_t wide{ v };
+                out.write( reinterpret_cast<const char *>( &wide ), sizeof( wide ) );
+            }
+        pad_to( sections[CATEGORY_IDS].offset ); write_ids( store.category_ids() );
+        pad_to( sections[FRAME_OFFSETS].offset );
+        out.write( reinterpret_cast<const char *>( store.offsets().data() ), store.offsets().size() * sizeof( std::uint64_t ) );
+
+        if ( !out.flush() )
+        {
+            error = "erro ao escrever \"" + filename + "\"";
+            return false;
+        }
+        return true;
+    }
+
+    bool load( MappedFile && file, DatasetHeader & header, unsigned & decimals, FrameStore & store, std::string & error )
+    {
+        const auto data = file.view();
+        FileHeader fh;
+        SectionEntry sections[N_SECTIONS];
+        if ( data.size() < sizeof( fh ) + sizeof( sections ) || !is_binary( data ) )
+        {
+            error = "arquivo binario invalido";
+            return false;
+        }
+        std::memcpy( &fh, data.data(), sizeof( fh ) );
+        if ( fh.endian_tag != endian_tag )
+        {
+            error = "arquivo binario gerado em uma maquina com outra ordem de bytes";
+            return false;
+        }
+        if ( fh.version != version || fh.n_sections != N_SECTIONS )
+        {
+            error = "versao do arquivo binario nao suportada (" + std::to_string( fh.version )
+                  + "), recompile-o com --compile";
+            return false;
+        }
+        if ( fh.decimals > ValueFormat::max_decimals )
+        {
+            error = "arquivo binario corrompido";
+            return false;
+        }
+        if constexpr ( sizeof( value_t ) != sizeof( std::int64_t ) )
+        {
+            error = "arquivos binarios exigem valores de 64 bits";
+            return false;
+        }
+        std::memcpy( sections, data.data() + sizeof( fh ), sizeof( sections ) );
+        for ( const auto & s : sections )
+            if ( s.offset % alignment != 0 || s.offset > data.size() || s.size > data.size() - s.offset )
+            {
+                error = "arquivo binario truncado ou corrompido";
+                return false;
+            }
+        // Bound the counts by the file size first, so the products below cannot overflow.
+        if ( fh.n_rows > data.size() / sizeof( std::int64_t ) || fh.n_frames >= data.size() / sizeof( std::uint64_t ) )
+        {
+            error = "arquivo binario corrompido";
+            return false;
+        }
+        const std::uint64_t row_bytes[] = { sections[TIME_IDS].size, sections[LABEL_IDS].size, sections[CATEGORY_IDS].size };
+        for ( auto bytes : row_bytes )
+            if ( bytes != fh.n_rows * sizeof( std::uint32_t ) ) { error = "arquivo binario corrompido"; return false; }
+        if ( sections[VALUES].size != fh.n_rows * sizeof( std::int64_t )
+             || sections[FRAME_OFFSETS].size != ( fh.n_frames ? fh.n_frames + 1 : 0 ) * sizeof( std::uint64_t ) )
+        {
+            error = "arquivo binario corrompido";
+            return false;
+        }
+
+        auto bytes = [&]( section_e s ) { return data.substr( sections[s].offset, sections[s].size ); };
+        auto & strings = interned();
+        if ( !strings.timestamps.empty() || !strings.labels.empty() || !strings.categories.empty() )
+        {
+            error = "a tabela de strings precisa estar vazia para carregar um arquivo binario";
+            return false;
+        }
+        if ( !read_table( bytes( TIMESTAMPS ), strings.timestamps ) || !read_table( bytes( LABELS ), strings.labels )
+             || !read_table( bytes( CATEGORIES ), strings.categories ) )
+        {
+            strings.clear();
+            error = "tabela de strings corrompida no arquivo binario";
+            return false;
+        }
+
+        FrameStore::Views views;
+        views.time_ids = column< str_id_t >( data.data(), sections[TIME_IDS] );
+        views.label_ids = column< str_id_t >( data.data(), sections[LABEL_IDS] );
+        views.values = column< value_t >( data.data(), sections[VALUES] );
+        views.category_ids = column< str_id_t >( data.data(), sections[CATEGORY_IDS] );
+        views.offsets = column< FrameStore::offset_t >( data.data(), sections[FRAME_OFFSETS] );
+
+        // The frames must cover the rows exactly, in order, and none may be empty (its time stamp would be
+        // read from the row past it): otherwise a corrupted file sends us out of bounds.
+        bool frames_ok = views.offsets.empty() ? fh.n_rows == 0
+                                               : views.offsets[0] == 0 && views.offsets[views.offsets.size() - 1] == fh.n_rows;
+        for ( std::size_t f{ 0 }; frames_ok && f + 1 < views.offsets.size(); ++f )
+            frames_ok = views.offsets[f] < views.offsets[f + 1];
+        if ( !frames_ok )
+        {
+            strings.clear();
+            error = "tabela de frames corrompida no arquivo binario";
+            return false;
+        }
+
+        // Every id is used to index a string table, so each one must exist. One pass over the ids.
+        auto ids_ok = [&]( const Column< str_id_t > & ids, const StringTable & table ) {
+            const auto n = table.size();
+            for ( auto id : ids )
+                if ( id >= n ) return false;
+            return true;
+        };
+        if ( !ids_ok( views.time_ids, strings.timestamps ) || !ids_ok( views.label_ids, strings.labels )
+             || !ids_ok( views.category_ids, strings.categories ) )
+        {
+            strings.clear();
+            error = "ids de strings corrompidos no arquivo binario";
+            return false;
+        }
+
+        header.title = bytes( TITLE );
+        header.value_label = bytes( VALUE_LABEL );
+        header.source = bytes( SOURCE );
+        decimals = fh.decimals;
+        store.adopt( std::move( file ), views ); // The mapping (and so `header`) stays valid.
+        return true;
+    }
+} // namespace bcrb.
+} // namespace bcra.
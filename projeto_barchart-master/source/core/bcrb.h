@@ -0,0 +1,59 @@
+#ifndef BCRB_H
+#define BCRB_H
+
+/*!
+ * Precompiled binary datasets (`.bcrb`).
+ *
+ * A `.bcrb` file holds a parsed dataset ready to be mapped and played:
+ * header strings, string tables and the fixed-width columns of the
+ * `FrameStore`. Loading one is just a `mmap()` plus a few sanity checks;
+ * the columns are used in place.
+ *
+ * Layout (native byte order, every section aligned to 64 bytes):
+ * ```
+ *   FileHeader                     magic, version, # of rows and frames, decimals
+ *   SectionEntry[n_sections]       offset and size of each section
+ *   title | value label | source   raw bytes
+ *   time stamps | labels | categories
+ *                                  string tables: u64 count, u64 offsets[count+1], bytes
+ *   time ids | label ids | category ids   u32[n_rows]
+ *   values                         i64[n_rows]
+ *   frame offsets                  u64[n_frames+1]
+ * ```
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "../libs/mapped_file.h"
+#include "loader.h"      // DatasetHeader
+#include "frame_store.h"
+
+namespace bcra {
+namespace bcrb {
+    /// Current version of the format. Bump it whenever the layout changes.
+    constexpr std::uint32_t version = 2;
+
+    /// Returns true if `data` starts like a `.bcrb` file.
+    bool is_binary( std::string_view data );
+
+    /// Writes `store` and its header into the binary file `filename`.
+    /*!
+     * @param decimals Decimal places the values were scaled by (`ValueFormat::decimals`).
+     * @return false, with the reason in `error`, if the file could not be written.
+     */
+    bool save( const std::string & filename, const DatasetHeader & header, unsigned decimals,
+               const FrameStore & store, std::string & error );
+
+    /// Adopts the mapped binary dataset `file` into `store`.
+    /*!
+     * The global intern table must be empty, since the ids in the file are used as they are.
+     * `header` points into the mapping, which is kept alive by `store`.
+     * @param decimals Receives the decimal places the values were scaled by.
+     * @return false, with the reason in `error`, if the file is not a valid `.bcrb`.
+     */
+    bool load( MappedFile && file, DatasetHeader & header, unsigned & decimals, FrameStore & store, std::string & error );
+} // namespace bcrb.
+} // namespace bcra.
+#endif
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "color_registry.h"
+
+namespace bcra {
+
+    namespace {
+        /// Indices of the xterm 6x6x6 cube (16..231) bright enough to read, grays excluded.
+        std::vector< int > cube_colors( void )
+        {
+            std::vector< int > colors;
+            for ( int r{ 0 }; r < 6; ++r )
+                for ( int g{ 0 }; g < 6; ++g )
+                    for ( int b{ 0 }; b < 6; ++b )
+                    {
+                        if ( std::max( { r, g, b } ) < 3 ) continue; // Too dark on a black terminal.
+                        if ( r == g && g == b ) continue;          // Gray.
+                        colors.push_back( 16 + 36 * r + 6 * g + b );
+                    }
+            return colors;
+        }
+
+        /// Hue `h` in [0,1), fixed saturation and value, as 0..255 RGB.
+        void hue_to_rgb( double h, int rgb[3] )
+        {
+            constexpr double s{ 0.65 }, v{ 0.95 };
+            const double f = h * 6.0 - std::floor( h * 6.0 );
+            const double p = v * ( 1 - s ), q = v * ( 1 - s * f ), t = v * ( 1 - s * ( 1 - f ) );
+            double c[3];
+            switch ( static_cast<int>( h * 6.0 ) % 6 )
+            {
+                case 0:  c[0] = v; c[1] = t; c[2] = p; break;
+                case 1:  c[0] = q; c[1] = v; c[2] = p; break;
+                case 2:  c[0] = p; c[1] = v; c[2] = t; break;
+                case 3:  c[0] = p; c[1] = q; c[2] = v; break;
+                case 4:  c[0] = t; c[1] = p; c[2] = v; break;
+                default: c[0] = v; c[1] = p; c[2] = q; break;
+            }
+            for ( int i{ 0 }; i < 3; ++i ) rgb[i] = static_cast<int>( std::lround( c[i] * 255 ) );
+        }
+    }
+
+    ColorRegistry::ColorRegistry( palette_e palette, Color::value_t fallback )
+        : m_palette{ palette }, m_fallback{ Color::prefix( fallback ) }
+    {
+        reset( palette );
+    }
+
+    void ColorRegistry::reset( palette_e palette )
+    {
+        m_palette = palette;
+        m_table.assign( 16, Entry{} );
+        m_shift = 64 - 4;
+        m_sgr.clear();
+        m_categories.clear();
+    }
+
+    std::uint32_t ColorRegistry::find( str_id_t category ) const
+    {
+        const std::size_t mask = m_table.size() - 1;
+        for ( auto i = bucket( category ); ; i = ( i + 1 ) & mask )
+        {
+            const auto & entry = m_table[i];
+            if ( entry.key == category ) return entry.slot;
+            if ( entry.key == intern_npos ) return npos;
+        }
+    }
+
+    std::uint32_t ColorRegistry::add( str_id_t category )
+    {
+        const auto found = find( category );
+        if ( found != npos ) return found;
+
+        if ( 2 * ( m_categories.size() + 1 ) > m_table.size() ) grow();
+        const auto slot = static_cast<std::uint32_t>( m_categories.size() );
+        const std::size_t mask = m_table.size() - 1;
+        auto i = bucket( category );
+        while ( m_table[i].key != intern_npos ) i = ( i + 1 ) & mask;
+        m_table[i] = Entry{ category, slot };
+        m_categories.push_back( category );
+        m_sgr.push_back( make_sgr( slot ) );
+        return slot;
+    }
+
+    void ColorRegistry::grow( void )
+    {
+        std::vector< Entry > old( m_table.size() * 2, Entry{} );
+        old.swap( m_table );
+        --m_shift;
+        const std::size_t mask = m_table.size() - 1;
+        for ( const auto & entry : old )
+        {
+            if ( entry.key == intern_npos ) continue;
+            auto i = bucket( entry.key );
+            while ( m_table[i].key != intern_npos ) i = ( i + 1 ) & mask;
+            m_table[i] = entry;
+        }
+    }
+
+    std::string ColorRegistry::make_sgr( std::size_t slot ) const
+    {
+        // The first slots are the classic colors, the same in every palette.
+        if ( slot < Color::color_list.size() ) return std::string{ Color::prefix( Color::color_list[slot] ) };
+        const std::size_t extra = slot - Color::color_list.size();
+        switch ( m_palette )
+        {
+            case palette_e::XTERM256:
+            {
+                static const std::vector< int > cube = cube_colors();
+                // A stride coprime with the size visits every color once before repeating,
+                // while jumping far enough that neighbor slots do not look alike.
+                std::size_t stride = cube.size() * 5 / 13;
+                while ( std::gcd( stride, cube.size() ) != 1 ) ++stride;
+                return "\33[0;38;5;" + std::to_string( cube[ extra * stride % cube.size() ] ) + "m";
+            }
+            case palette_e::TRUECOLOR:
+            {
+                // Golden angle steps around the hue circle: consecutive slots always differ.
+                const double golden{ 0.6180339887498949 };
+                const double h = std::fmod( 0.1 + extra * golden, 1.0 );
+                int rgb[3];
+                hue_to_rgb( h, rgb );
+                return "\33[0;38;2;" + std::to_string( rgb[0] ) + ";" + std::to_string( rgb[1] ) + ";"
+                       + std::to_string( rgb[2] ) + "m";
+            }
+            default:
+                return m_fallback;
+        }
+    }
+} // namespace bcra.
@@ -0,0 +1,100 @@
+#ifndef COLOR_REGISTRY_H
+#define COLOR_REGISTRY_H
+
+/*!
+ * Category colors.
+ *
+ * Each category gets a color slot the first time it is registered; the
+ * escape sequence of every slot is built once, so coloring a bar is a single
+ * hash lookup that hands back a ready-made `std::string_view`.
+ *
+ * The lookup is an open-addressing table (linear probing, power-of-two
+ * capacity, at most half full) keyed by the interned category id.
+ *
+ * The first 14 slots use the classic `Color::color_list`. After that:
+ *  - `BASIC`     : the remaining categories share `Cfg::default_color`.
+ *  - `XTERM256`  : colors of the 6x6x6 xterm cube (dark and gray ones left out).
+ *  - `TRUECOLOR` : 24-bit colors spread around the hue circle, never repeating.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../libs/text_color.h"
+#include "intern.h"
+
+namespace bcra {
+    /// Which colors the slots past `Color::color_list` get.
+    enum class palette_e : unsigned char {
+        BASIC = 0, //!< Only the 16 ANSI colors.
+        XTERM256,  //!< 256-color terminals.
+        TRUECOLOR  //!< 24-bit color terminals.
+    };
+
+    /// Maps each category id to its color.
+    class ColorRegistry {
+        public:
+            static constexpr std::uint32_t npos = static_cast<std::uint32_t>( -1 );
+
+            explicit ColorRegistry( palette_e palette = palette_e::XTERM256, Color::value_t fallback = Color::GREEN );
+
+            /// Forgets every category and switches to `palette`.
+            void reset( palette_e palette );
+            /// Gives `category` a color slot, if it has none yet. Returns the slot.
+            std::uint32_t add( str_id_t category );
+            /// Returns the slot of `category`, or `npos`.
+            std::uint32_t find( str_id_t category ) const;
+
+            /// Escape sequence that turns on the color of `category` (the fallback color if it was never added).
+            std::string_view sgr( str_id_t category ) const
+            {
+                const auto slot = find( category );
+                return slot == npos ? m_fallback : m_sgr[slot];
+            }
+            /// Escape sequence of a slot.
+            std::string_view slot_sgr( std::uint32_t slot ) const { return m_sgr[slot]; }
+            /// Category that owns a slot.
+            str_id_t slot_category( std::uint32_t slot ) const { return m_categories[slot]; }
+            /// # of registered categories (slots are 0 .. size()-1, in registration order).
+            std::size_t size( void ) const { return m_categories.size(); }
+            palette_e palette( void ) const { return m_palette; }
+
+            /// Appends `text` in the color of `category` to `out` (anything with `append( std::string_view )`).
+            template < typename Buffer >
+            Buffer & append( Buffer & out, std::string_view text, str_id_t category ) const
+            {
+                out.append( sgr( category ) );
+                out.append( text );
+                out.append( Color::reset );
+                return out;
+            }
+
+        private:
+            /// One entry of the hash table.
+            struct Entry {
+                str_id_t key = intern_npos; //!< Category id (`intern_npos` when empty).
+                std::uint32_t slot = 0;     //!< Color slot.
+            };
+            static constexpr str_id_t intern_npos = StringTable::npos;
+
+            /// Home bucket of `key` (Fibonacci hashing, so consecutive ids spread out).
+            std::size_t bucket( str_id_t key ) const
+            {
+                return static_cast<std::size_t>( ( std::uint64_t{ key } * 0x9E3779B97F4A7C15ull ) >> m_shift );
+            }
+            void grow( void );
+            /// Escape sequence of the `slot`-th color of the palette.
+            std::string make_sgr( std::size_t slot ) const;
+
+            palette_e m_palette;
+            std::string m_fallback;              //!< Sequence of the default color.
+            std::vector< Entry > m_table;        //!< Open-addressing table; size is a power of two.
+            unsigned m_shift = 64;               //!< 64 - log2( table size ).
+            std::vector< std::string > m_sgr;    //!< Slot -> escape sequence.
+            std::vector< str_id_t > m_categories; //!< Slot -> category id.
+    };
+} // namespace bcra.
+#endif
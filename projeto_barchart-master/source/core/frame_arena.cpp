@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include "frame_arena.h"
+
+namespace bcra {
+
+    namespace {
+        constexpr std::size_t header_size = ( sizeof( void * ) + sizeof( std::size_t ) + alignof( std::max_align_t ) - 1 )
+                                          / alignof( std::max_align_t ) * alignof( std::max_align_t );
+    }
+
+    FrameArena::FrameArena( std::size_t capacity, std::pmr::memory_resource * upstream )
+        : m_upstream{ upstream }
+    {
+        push_block( capacity );
+    }
+
+    FrameArena::~FrameArena()
+    {
+        release();
+    }
+
+    void FrameArena::push_block( std::size_t size )
+    {
+        void * memory = m_upstream->allocate( header_size + size, alignof( std::max_align_t ) );
+        m_head = ::new ( memory ) Block{ m_head, size };
+        m_cursor = static_cast<char *>( memory ) + header_size;
+        m_limit = m_cursor + size;
+        ++m_refills;
+    }
+
+    void FrameArena::release( void )
+    {
+        while ( m_head != nullptr )
+        {
+            Block * next = m_head->next;
+            m_upstream->deallocate( m_head, header_size + m_head->size, alignof( std::max_align_t ) );
+            m_head = next;
+        }
+        m_cursor = m_limit = nullptr;
+    }
+
+    void FrameArena::reset( void )
+    {
+        if ( m_head != nullptr && m_head->next != nullptr )
+        {
+            // The frame overflowed: one block that fits the peak replaces them all.
+            std::size_t total{ 0 };
+            for ( Block * b = m_head; b != nullptr; b = b->next ) total += b->size;
+            release();
+            push_block( std::max( total, m_peak ) );
+        }
+        else if ( m_head != nullptr )
+            m_cursor = reinterpret_cast<char *>( m_head ) + header_size;
+        m_used = 0;
+    }
+
+    void * FrameArena::do_allocate( std::size_t bytes, std::size_t alignment )
+    {
+        auto aligned = [&]() {
+            const auto p = reinterpret_cast<std::uintptr_t>( m_cursor );
+            return reinterpret_cast<char *>( ( p + alignment - 1 ) & ~static_cast<std::uintptr_t>( alignment - 1 ) );
+        };
+        char * p = m_cursor == nullptr ? nullptr : aligned();
+        if ( p == nullptr || p > m_limit || static_cast<std::size_t>( m_limit - p ) < bytes )
+        {
+            // Does not fit: a new block, at least as large as the current one.
+            const std::size_t current = m_head != nullptr ? m_head->size : 0;
+            push_block( std::max( current, bytes + alignment ) );
+            p = aligned();
+        }
+        m_used += static_cast<std::size_t>( p + bytes - m_cursor );
+        m_peak = std::max( m_peak, m_used );
+        m_cursor = p + bytes;
+        return p;
+    }
+} // namespace bcra.
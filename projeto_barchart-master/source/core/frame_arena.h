@@ -0,0 +1,68 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+/*!
+ * Bump allocator for the scratch memory of one frame.
+ *
+ * Everything a frame needs only while it is being built (e.g. the work
+ * arrays of a ranking) is carved out of one block by moving a pointer, and
+ * the whole block is given back at once by `reset()` after the frame is
+ * drawn. Individual deallocations do nothing.
+ *
+ * When a frame needs more than the block holds, extra blocks are taken from
+ * the upstream resource; the next `reset()` swaps them all for a single
+ * block as large as the peak, so once the race has warmed up a frame makes
+ * no heap allocation at all.
+ */
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace bcra {
+    /// Per-frame arena, usable by any `std::pmr` container.
+    class FrameArena : public std::pmr::memory_resource {
+        public:
+            static constexpr std::size_t default_capacity = 64 * 1024;
+
+            explicit FrameArena( std::size_t capacity = default_capacity,
+                                 std::pmr::memory_resource * upstream = std::pmr::new_delete_resource() );
+            FrameArena( const FrameArena & ) = delete;
+            FrameArena & operator=( const FrameArena & ) = delete;
+            ~FrameArena();
+
+            /// Frees everything allocated since the last reset. Nothing handed out may be used afterwards.
+            void reset( void );
+
+            /// Bytes handed out since the last reset (alignment padding included).
+            std::size_t used( void ) const { return m_used; }
+            /// Most bytes handed out between two resets.
+            std::size_t peak( void ) const { return m_peak; }
+            /// # of blocks taken from the upstream resource so far.
+            std::size_t refills( void ) const { return m_refills; }
+
+        private:
+            /// Header of a block; its bytes follow it.
+            struct Block {
+                Block * next;       //!< Block that was current before this one.
+                std::size_t size;   //!< Usable bytes.
+            };
+
+            void * do_allocate( std::size_t bytes, std::size_t alignment ) override;
+            void do_deallocate( void *, std::size_t, std::size_t ) override { /* Freed by reset(). */ }
+            bool do_is_equal( const std::pmr::memory_resource & other ) const noexcept override { return this == &other; }
+
+            /// Makes a block of at least `size` bytes the current one.
+            void push_block( std::size_t size );
+            /// Gives every block back to the upstream resource.
+            void release( void );
+
+            std::pmr::memory_resource * m_upstream;
+            Block * m_head = nullptr;      //!< Current block (the others follow through `next`).
+            char * m_cursor = nullptr;     //!< Next free byte of the current block.
+            char * m_limit = nullptr;      //!< End of the current block.
+            std::size_t m_used = 0;
+            std::size_t m_peak = 0;
+            std::size_t m_refills = 0;
+    };
+} // namespace bcra.
+#endif
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <thread>
+
+#include "frame_clock.h"
+
+namespace bcra {
+
+    void FrameClock::set_rate( double fps )
+    {
+        m_fps = fps > 0.0 ? fps : 1.0;
+        m_period = std::chrono::duration_cast< clock::duration >( std::chrono::duration< double >( 1.0 / m_fps ) );
+    }
+
+    void FrameClock::start( void )
+    {
+        m_started = true;
+        m_first = m_last = clock::now();
+        m_deadline = m_first + m_period;
+        m_frames = 1;
+        m_dropped = 0;
+        m_max_us = 0;
+        m_histogram.fill( 0 );
+    }
+
+    std::size_t FrameClock::wait( void )
+    {
+        std::size_t advance{ 1 };
+        if ( !m_started )
+        {
+            // Nothing to pace against yet: this frame is shown right away.
+            start();
+            return advance;
+        }
+
+        auto now = clock::now();
+        if ( now < m_deadline )
+        {
+            std::this_thread::sleep_until( m_deadline );
+            now = clock::now();
+            m_deadline += m_period;
+        }
+        else
+        {
+            // Late: skip every frame whose deadline has already passed.
+            const auto late = static_cast<std::size_t>( ( now - m_deadline ) / m_period );
+            if ( late > max_catch_up )
+                m_deadline = now + m_period; // A long stall (e.g. the process was stopped): start over.
+            else
+            {
+                advance += late;
+                m_dropped += late;
+                m_deadline += m_period * static_cast<clock::rep>( late + 1 );
+            }
+        }
+
+        const auto us = static_cast<std::uint64_t>( std::chrono::duration_cast< std::chrono::microseconds >( now - m_last ).count() );
+        m_histogram[ std::min< std::uint64_t >( us / bucket_us, m_histogram.size() - 1 ) ] += 1;
+        m_max_us = std::max( m_max_us, us );
+        m_last = now;
+        m_frames += 1;
+        return advance;
+    }
+
+    double FrameClock::achieved_fps( void ) const
+    {
+        const double seconds = std::chrono::duration< double >( m_last - m_first ).count();
+        return m_frames > 1 && seconds > 0.0 ? ( m_frames - 1 ) / seconds : 0.0;
+    }
+
+    double FrameClock::percentile( double p ) const
+    {
+        std::uint64_t total{ 0 };
+        for ( auto n : m_histogram ) total += n;
+        if ( total == 0 ) return 0.0;
+        const auto wanted = static_cast<std::uint64_t>( p / 100.0 * total + 0.5 );
+        std::uint64_t seen{ 0 };
+        for ( std::size_t b{ 0 }; b < m_histogram.size(); ++b )
+        {
+            seen += m_histogram[b];
+            // Upper edge of the bucket, which may lie past the slowest frame that landed in it.
+            if ( seen >= wanted && seen > 0 ) return std::min( ( b + 1 ) * bucket_us / 1000.0, max_frame_ms() );
+        }
+        return max_frame_ms();
+    }
+} // namespace bcra.
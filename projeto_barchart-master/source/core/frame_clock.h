@@ -0,0 +1,75 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+/*!
+ * Frame pacing for the animation.
+ *
+ * Frames are due at absolute `steady_clock` deadlines (start + k * period),
+ * so the time spent updating and drawing a frame does not add up to the
+ * period, and a late frame does not push all the following ones. When the
+ * animation falls a whole period behind, the frames it missed are dropped:
+ * the caller advances the animation several steps and draws only the last.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace bcra {
+    /// Paces frames at a fixed rate and keeps frame time statistics.
+    class FrameClock {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            /// At most this many frames are dropped at once; past that the clock starts over.
+            static constexpr std::size_t max_catch_up = 60;
+
+            /// Sets the rate, in frames per second. Takes effect on the next `start()`.
+            void set_rate( double fps );
+            /// Starts counting from now: the frame drawn next is due now, the one after it one period later.
+            void start( void );
+
+            /// Sleeps until the next frame is due.
+            /*!
+             * @return # of frames the animation must advance before drawing: 1 when on time,
+             *         more when frames had to be dropped to catch up.
+             */
+            std::size_t wait( void );
+
+            //== Statistics.
+            /// # of frames drawn (calls to `wait()`).
+            std::size_t frames( void ) const { return m_frames; }
+            /// # of frames dropped to keep up with the deadlines.
+            std::size_t dropped( void ) const { return m_dropped; }
+            /// Frames per second actually achieved.
+            double achieved_fps( void ) const;
+            /// Target frames per second.
+            double target_fps( void ) const { return m_fps; }
+            /// Time between frames below which `p` percent of the frames fall, in ms.
+            /*!
+             * Read from the histogram, so it is the upper edge of a bucket, capped at
+             * `max_frame_ms()`: a percentile never exceeds the longest frame measured.
+             */
+            double percentile( double p ) const;
+            /// Longest time between two frames, in ms.
+            double max_frame_ms( void ) const { return m_max_us / 1000.0; }
+
+        private:
+            /// Width of one histogram bucket, in microseconds.
+            static constexpr std::uint32_t bucket_us = 100;
+            /// Frame times of 0..1 s in 0.1 ms buckets; the last one takes everything longer.
+            std::array< std::uint32_t, 10001 > m_histogram{};
+
+            double m_fps = 24.0;
+            clock::duration m_period = std::chrono::microseconds{ 41667 };
+            bool m_started = false;
+            clock::time_point m_first;     //!< When the first frame was drawn.
+            clock::time_point m_last;      //!< When the last frame was drawn.
+            clock::time_point m_deadline;  //!< When the next frame is due.
+            std::size_t m_frames = 0;
+            std::size_t m_dropped = 0;
+            std::uint64_t m_max_us = 0;
+    };
+} // namespace bcra.
+#endif
@@ -0,0 +1,107 @@
+#include <algorithm>
+
+#include "frame_index.h"
+#include "frame_store.h"
+
+namespace bcra {
+
+    namespace {
+        /// True if `s` is an integer: an optional '-' followed by digits only.
+        bool is_integer( std::string_view s )
+        {
+            if ( !s.empty() && s.front() == '-' ) s.remove_prefix( 1 );
+            return !s.empty() && std::all_of( s.begin(), s.end(), []( char c ) { return c >= '0' && c <= '9'; } );
+        }
+
+        /// Compares two non-negative integers written in decimal, of any length.
+        int compare_digits( std::string_view a, std::string_view b )
+        {
+            auto strip = []( std::string_view s ) {
+                while ( s.size() > 1 && s.front() == '0' ) s.remove_prefix( 1 );
+                return s;
+            };
+            a = strip( a );
+            b = strip( b );
+            if ( a.size() != b.size() ) return a.size() < b.size() ? -1 : 1;
+            return a.compare( b );
+        }
+
+        /// Compares two integers (see `is_integer()`) by value.
+        int compare_integers( std::string_view a, std::string_view b )
+        {
+            const bool neg_a = a.front() == '-', neg_b = b.front() == '-';
+            if ( neg_a != neg_b ) return neg_a ? -1 : 1;
+            if ( neg_a ) return compare_digits( b.substr( 1 ), a.substr( 1 ) );
+            return compare_digits( a, b );
+        }
+    }
+
+    int compare_time( std::string_view a, std::string_view b )
+    {
+        if ( !is_integer( a ) || !is_integer( b ) ) return a.compare( b );
+        return compare_integers( a, b );
+    }
+
+    void FrameIndex::build( const FrameStore & store )
+    {
+        m_store = &store;
+        m_frames = store.frames();
+        // First pick the rule for the whole dataset, then check the order with it.
+        m_numeric = true;
+        for ( std::size_t f{ 0 }; f < m_frames && m_numeric; ++f )
+            m_numeric = is_integer( time( f ) );
+        m_ordered = true;
+        for ( std::size_t f{ 1 }; f < m_frames && m_ordered; ++f )
+            m_ordered = compare( time( f - 1 ), time( f ) ) <= 0;
+    }
+
+    int FrameIndex::compare( std::string_view a, std::string_view b ) const
+    {
+        return m_numeric ? compare_integers( a, b ) : a.compare( b );
+    }
+
+    std::string_view FrameIndex::time( std::size_t f ) const
+    {
+        return m_store->frame_time( f );
+    }
+
+    std::size_t FrameIndex::first_at_or_after( std::string_view stamp ) const
+    {
+        if ( m_numeric && !is_integer( stamp ) ) return npos; // Not comparable with the stamps.
+        if ( m_ordered )
+        {
+            // Binary search for the first frame not before `stamp`.
+            std::size_t lo{ 0 }, hi{ m_frames };
+            while ( lo < hi )
+            {
+                const auto mid = lo + ( hi - lo ) / 2;
+                if ( compare( time( mid ), stamp ) < 0 ) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+        for ( std::size_t f{ 0 }; f < m_frames; ++f )
+            if ( compare( time( f ), stamp ) == 0 ) return f;
+        return npos;
+    }
+
+    std::size_t FrameIndex::end_at_or_before( std::string_view stamp ) const
+    {
+        if ( m_numeric && !is_integer( stamp ) ) return npos;
+        if ( m_ordered )
+        {
+            // Binary search for the first frame after `stamp`.
+            std::size_t lo{ 0 }, hi{ m_frames };
+            while ( lo < hi )
+            {
+                const auto mid = lo + ( hi - lo ) / 2;
+                if ( compare( time( mid ), stamp ) <= 0 ) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+        for ( std::size_t f{ m_frames }; f > 0; --f )
+            if ( compare( time( f - 1 ), stamp ) == 0 ) return f;
+        return npos;
+    }
+} // namespace bcra.
@@ -0,0 +1,70 @@
+#ifndef FRAME_INDEX_H
+#define FRAME_INDEX_H
+
+/*!
+ * Time stamp -> frame lookup over a `FrameStore`.
+ *
+ * Frames are already random access (the store keeps the first row of each
+ * one), so the index only has to find a frame from its time stamp. When the
+ * stamps of the dataset are in order, which is checked once when the index
+ * is built, that is a binary search: O(log n) string comparisons, even for
+ * races with millions of frames. Otherwise it falls back to a linear scan
+ * for an exact match.
+ *
+ * The comparison is chosen once per dataset, when the index is built: if
+ * every stamp is an integer (years, epoch seconds) they are compared as
+ * numbers, so `"999" < "1000"`; otherwise all of them are compared as text
+ * (e.g. ISO dates). A single rule keeps the order consistent, which mixing
+ * both per pair of stamps would not.
+ */
+
+#include <cstddef>
+#include <string_view>
+
+namespace bcra {
+    class FrameStore;
+
+    /// Compares two time stamps: < 0, 0 or > 0, as `a` comes before, with or after `b`.
+    /*!
+     * Numerically if both are integers, as text otherwise. That is only an order
+     * among stamps of one kind, so it is meant for one-off checks (like the
+     * --from/--to filter of --stream mode); `FrameIndex` does not use it.
+     */
+    int compare_time( std::string_view a, std::string_view b );
+
+    /// Finds frames by time stamp.
+    class FrameIndex {
+        public:
+            static constexpr std::size_t npos = static_cast<std::size_t>( -1 );
+
+            /// Indexes the frames of `store`, which must outlive the index. O(frames).
+            void build( const FrameStore & store );
+
+            /// First frame whose stamp is `time` or later (`frames()` if none).
+            /*!
+             * `npos` if the stamps are unordered and none is `time`, or if they are
+             * numeric and `time` is not an integer.
+             */
+            std::size_t first_at_or_after( std::string_view time ) const;
+            /// One past the last frame whose stamp is `time` or earlier (0 if none); `npos` as above.
+            std::size_t end_at_or_before( std::string_view time ) const;
+
+            /// # of frames indexed.
+            std::size_t frames( void ) const { return m_frames; }
+            /// True if the stamps never go back in time (so the searches are binary).
+            bool ordered( void ) const { return m_ordered; }
+            /// True if every stamp is an integer, so they are compared as numbers.
+            bool numeric( void ) const { return m_numeric; }
+
+        private:
+            std::string_view time( std::size_t f ) const;
+            /// Compares with the rule chosen by `build()`.
+            int compare( std::string_view a, std::string_view b ) const;
+
+            const FrameStore * m_store = nullptr;
+            std::size_t m_frames = 0;
+            bool m_ordered = true;
+            bool m_numeric = true;
+    };
+} // namespace bcra.
+#endif
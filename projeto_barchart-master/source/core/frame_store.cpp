@@ -0,0 +1,86 @@
+#include "frame_store.h"
+
+namespace bcra {
+
+    void FrameStore::begin_frame( void )
+    {
+        begin_frame_at( m_values.size() );
+    }
+
+    void FrameStore::begin_frame_at( std::size_t row )
+    {
+        // An open frame with no rows is simply reused.
+        if ( m_offsets.empty() || m_offsets.back() < row )
+            m_offsets.push_back( row );
+    }
+
+    FrameStore::RowSpan FrameStore::append_rows( std::size_t n )
+    {
+        const auto first = m_values.size();
+        m_time_ids.resize( first + n );
+        m_label_ids.resize( first + n );
+        m_values.resize( first + n );
+        m_category_ids.resize( first + n );
+        sync();
+        return RowSpan{ m_time_ids.data() + first, m_label_ids.data() + first,
+                        m_values.data() + first, m_category_ids.data() + first };
+    }
+
+    void FrameStore::add( std::string_view time_stamp, std::string_view label, value_t value, std::string_view category )
+    {
+        if ( m_offsets.empty() ) begin_frame(); // Records before the first count line.
+        auto & strings = interned();
+        m_time_ids.push_back( strings.timestamps.intern( time_stamp ) );
+        m_label_ids.push_back( strings.labels.intern( label ) );
+        m_values.push_back( value );
+        m_category_ids.push_back( strings.categories.intern( category ) );
+        sync();
+    }
+
+    void FrameStore::finish( void )
+    {
+        // After this, m_offsets holds frames() + 1 entries, the last one being the end of the last frame.
+        if ( m_offsets.empty() || m_offsets.front() != 0 )
+            m_offsets.insert( m_offsets.begin(), 0 ); // Rows before the first count line.
+        if ( m_offsets.back() == m_values.size() )
+            m_offsets.pop_back();
+        m_offsets.push_back( m_values.size() );
+        if ( m_offsets.size() == 1 ) m_offsets.clear(); // No frames at all.
+        sync();
+    }
+
+    void FrameStore::clear( void )
+    {
+        m_time_ids.clear();
+        m_label_ids.clear();
+        m_values.clear();
+        m_category_ids.clear();
+        m_offsets.clear();
+        m_backing.close();
+        sync();
+    }
+
+    void FrameStore::adopt( MappedFile && backing, const Views & views )
+    {
+        clear();
+        m_backing = std::move( backing );
+        m_view = views;
+    }
+
+    void FrameStore::sync( void )
+    {
+        m_view.time_ids = Column< str_id_t >{ m_time_ids.data(), m_time_ids.size() };
+        m_view.label_ids = Column< str_id_t >{ m_label_ids.data(), m_label_ids.size() };
+        m_view.values = Column< value_t >{ m_values.data(), m_values.size() };
+        m_view.category_ids = Column< str_id_t >{ m_category_ids.data(), m_category_ids.size() };
+        m_view.offsets = Column< offset_t >{ m_offsets.data(), m_offsets.size() };
+    }
+
+    std::size_t FrameStore::memory_bytes( void ) const
+    {
+        return ( m_time_ids.capacity() + m_label_ids.capacity() + m_category_ids.capacity() ) * sizeof( str_id_t )
+             + m_values.capacity() * sizeof( value_t )
+             + m_offsets.capacity() * sizeof( offset_t )
+             + timestamps().memory_bytes() + labels().memory_bytes() + categories().memory_bytes();
+    }
+} // namespace bcra.
@@ -0,0 +1,137 @@
+#ifndef FRAME_STORE_H
+#define FRAME_STORE_H
+
+/*!
+ * Columnar storage for all bar charts (frames) of a race.
+ *
+ * Every record of the input file becomes one row, split across one
+ * contiguous array per field. Strings live in the global intern table
+ * (see `interned()`), so a row costs only three ids and one value.
+ * Frame `f` owns rows `[begin(f), end(f))`.
+ *
+ * The columns are either owned by the store (text input) or point
+ * straight into a mapped binary dataset (see `bcrb.h`).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "../libs/mapped_file.h"
+#include "barchart.h" // value_t
+#include "intern.h"
+
+namespace bcra {
+    /// Read-only view over a contiguous column.
+    template < typename T >
+    class Column {
+        public:
+            Column() = default;
+            Column( const T * data, std::size_t size ) : m_data{ data }, m_size{ size } {}
+
+            const T & operator[]( std::size_t i ) const { return m_data[i]; }
+            const T * data( void ) const { return m_data; }
+            const T * begin( void ) const { return m_data; }
+            const T * end( void ) const { return m_data + m_size; }
+            std::size_t size( void ) const { return m_size; }
+            bool empty( void ) const { return m_size == 0; }
+
+        private:
+            const T * m_data = nullptr;
+            std::size_t m_size = 0;
+    };
+
+    /// Holds every record of the dataset, one array per column.
+    class FrameStore {
+        public:
+            using offset_t = std::uint64_t; //!< Type of the frame offset table entries.
+
+            FrameStore() = default;
+            FrameStore( const FrameStore & ) = delete;
+            FrameStore & operator=( const FrameStore & ) = delete;
+
+            /// Starts a new frame. Frames left empty are dropped.
+            void begin_frame( void );
+            /// Appends a record to the current frame (opening one if needed).
+            void add( std::string_view time_stamp, std::string_view label, value_t value, std::string_view category );
+            /// Closes the last frame. Must be called once all records were added.
+            void finish( void );
+            /// Removes all data.
+            void clear( void );
+
+            //== Bulk loading (used by the parallel loader).
+            /// Writable view over rows created by `append_rows()`.
+            struct RowSpan {
+                str_id_t * time_ids;
+                str_id_t * label_ids;
+                value_t * values;
+                str_id_t * category_ids;
+            };
+            /// Appends `n` rows for the caller to fill in, possibly from several threads.
+            /*!
+             * The ids written must already belong to the global intern table.
+             * @return Pointers to the first new row of each column.
+             */
+            RowSpan append_rows( std::size_t n );
+            /// Starts a new frame at row `row`. Frames must be opened in increasing row order.
+            void begin_frame_at( std::size_t row );
+
+            /// Columns of a store living in external memory.
+            struct Views {
+                Column< str_id_t > time_ids;
+                Column< str_id_t > label_ids;
+                Column< value_t > values;
+                Column< str_id_t > category_ids;
+                Column< offset_t > offsets; //!< frames() + 1 entries.
+            };
+            /// Replaces the contents of the store by `views`, which point into `backing`.
+            /*!
+             * The store keeps `backing` mapped for as long as it uses the views.
+             * Nothing is copied, so this is O(1) regardless of the dataset size.
+             */
+            void adopt( MappedFile && backing, const Views & views );
+
+            //== Frame access.
+            /// # of frames (bar charts).
+            std::size_t frames( void ) const { return m_view.offsets.empty() ? 0 : m_view.offsets.size() - 1; }
+            /// Index of the first row of frame `f`.
+            std::size_t begin( std::size_t f ) const { return m_view.offsets[f]; }
+            /// One past the last row of frame `f`.
+            std::size_t end( std::size_t f ) const { return m_view.offsets[f + 1]; }
+            /// # of rows of frame `f`.
+            std::size_t frame_size( std::size_t f ) const { return end( f ) - begin( f ); }
+            /// The time stamp of frame `f` (the one of its first row).
+            std::string_view frame_time( std::size_t f ) const { return timestamps()[ m_view.time_ids[ begin( f ) ] ]; }
+
+            //== Column access.
+            /// Total # of rows.
+            std::size_t records( void ) const { return m_view.values.size(); }
+            const Column< str_id_t > & time_ids( void ) const { return m_view.time_ids; }
+            const Column< str_id_t > & label_ids( void ) const { return m_view.label_ids; }
+            const Column< value_t > & values( void ) const { return m_view.values; }
+            const Column< str_id_t > & category_ids( void ) const { return m_view.category_ids; }
+            const Column< offset_t > & offsets( void ) const { return m_view.offsets; }
+
+            //== String tables (shortcuts to the global intern table).
+            const StringTable & timestamps( void ) const { return interned().timestamps; }
+            const StringTable & labels( void ) const { return interned().labels; }
+            const StringTable & categories( void ) const { return interned().categories; }
+
+            /// Approximated # of heap bytes held by the store (string tables included).
+            std::size_t memory_bytes( void ) const;
+
+        private:
+            /// Points the views at the owned vectors.
+            void sync( void );
+
+            std::vector< str_id_t > m_time_ids;     //!< Time stamp of each row.
+            std::vector< str_id_t > m_label_ids;    //!< Label of each row.
+            std::vector< value_t > m_values;        //!< Value of each row.
+            std::vector< str_id_t > m_category_ids; //!< Category of each row.
+            std::vector< offset_t > m_offsets;      //!< First row of each frame, plus one past the last row.
+            MappedFile m_backing;                   //!< Mapped binary dataset, when the views point into it.
+            Views m_view;                           //!< What the accessors actually read.
+    };
+} // namespace bcra.
+#endif
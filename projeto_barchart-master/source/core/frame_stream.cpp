@@ -0,0 +1,217 @@
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "frame_stream.h"
+
+namespace bcra {
+
+    namespace {
+        /// Size of each read from the input file.
+        constexpr std::size_t read_block = 1 << 20;
+
+        /// Hands out the lines of a file read through a fixed-size buffer.
+        class LineSource {
+            public:
+                explicit LineSource( std::FILE * file ) : m_file{ file }, m_buf( read_block ) {}
+
+                /// Returns the next line (valid until the next call). False at the end of the file.
+                bool next( std::string_view & line )
+                {
+                    for ( ;; )
+                    {
+                        const char * begin = m_buf.data() + m_begin;
+                        const void * nl = std::memchr( begin, '\n', m_end - m_begin );
+                        if ( nl != nullptr )
+                        {
+                            auto len = static_cast<const char *>( nl ) - begin;
+                            line = std::string_view{ begin, static_cast<std::size_t>( len ) };
+                            m_begin += len + 1;
+                            return true;
+                        }
+                        if ( m_eof )
+                        {
+                            if ( m_begin == m_end ) return false;
+                            line = std::string_view{ begin, m_end - m_begin }; // Last line has no '\n'.
+                            m_begin = m_end;
+                            return true;
+                        }
+                        refill();
+                    }
+                }
+
+            private:
+                void refill( void )
+                {
+                    // Keep the partial line, growing the buffer only for lines longer than it.
+                    std::memmove( m_buf.data(), m_buf.data() + m_begin, m_end - m_begin );
+                    m_end -= m_begin;
+                    m_begin = 0;
+                    if ( m_end == m_buf.size() ) m_buf.resize( m_buf.size() * 2 );
+                    auto n = std::fread( m_buf.data() + m_end, 1, m_buf.size() - m_end, m_file );
+                    if ( m_first && n >= 3 && std::memcmp( m_buf.data(), "\xEF\xBB\xBF", 3 ) == 0 )
+                        m_begin = 3; // UTF-8 BOM.
+                    m_first = false;
+                    m_end += n;
+                    if ( n == 0 ) m_eof = true;
+                }
+
+                std::FILE * m_file;
+                std::vector< char > m_buf;
+                std::size_t m_begin = 0;
+                std::size_t m_end = 0;
+                bool m_eof = false;
+                bool m_first = true;
+        };
+    }
+
+    void StreamFrame::clear( void )
+    {
+        label_ids.clear();
+        values.clear();
+        category_ids.clear();
+        time.clear();
+        new_labels.clear();
+        new_categories.clear();
+    }
+
+    str_id_t FrameStream::LocalTable::intern( std::string_view str, std::vector< std::string > & fresh )
+    {
+        const auto before = table.size();
+        const auto id = table.intern( str );
+        if ( table.size() > before ) fresh.emplace_back( str );
+        return id;
+    }
+
+    FrameStream::FrameStream( std::size_t capacity )
+        : m_ring( capacity == 0 ? 1 : capacity )
+    { /* empty */ }
+
+    bool FrameStream::open( const std::string & filename, const RecordLayout & layout,
+                            std::string header[3], std::string & error )
+    {
+        close();
+        m_file = std::fopen( filename.c_str(), "rb" );
+        if ( m_file == nullptr )
+        {
+            error = "nao foi possivel abrir \"" + filename + "\"";
+            return false;
+        }
+        m_layout = layout;
+        m_head = m_count = m_malformed = m_delivered = 0;
+        m_eof = m_stop = false;
+        m_label_map.clear();
+        m_category_map.clear();
+
+        // The header is read right away, so the welcome screen can show it.
+        auto source = std::make_shared< LineSource >( m_file );
+        for ( int i{ 0 }; i < 3; ++i )
+        {
+            std::string_view line;
+            if ( !source->next( line ) )
+            {
+                error = "arquivo de entrada sem cabecalho: " + filename;
+                close();
+                return false;
+            }
+            header[i] = trim( line );
+        }
+        m_producer = std::thread{ [this, source]() {
+            // Everything below runs on the producer thread.
+            LocalTable labels, categories;
+            StreamFrame frame;
+            Fields fields;
+            std::string scratch;
+            std::size_t count{ 0 };
+            std::size_t malformed{ 0 };
+            const auto min_fields = m_layout.min_fields();
+            std::string_view line;
+            while ( source->next( line ) )
+            {
+                auto kind = DatasetReader{ line, m_layout.delimiter }.next( fields, count );
+                if ( kind == DatasetReader::line_e::COUNT )
+                {
+                    if ( !frame.values.empty() && !push( frame ) ) return;
+                }
+                else if ( kind == DatasetReader::line_e::RECORD )
+                {
+                    value_t value{ 0 };
+                    if ( fields.size() < min_fields || !parse_value( fields[m_layout.value_idx], value, m_layout.value_format ) )
+                    {
+                        malformed += 1;
+                        continue;
+                    }
+                    if ( frame.values.empty() )
+                        frame.time.assign( fields.unescaped( m_layout.date_idx, scratch ) );
+                    frame.label_ids.push_back( labels.intern( fields.unescaped( m_layout.label_idx, scratch ), frame.new_labels ) );
+                    frame.values.push_back( value );
+                    frame.category_ids.push_back( categories.intern( fields.unescaped( m_layout.category_idx, scratch ), frame.new_categories ) );
+                }
+            }
+            if ( !frame.values.empty() && !push( frame ) ) return;
+
+            std::lock_guard< std::mutex > lock{ m_mutex };
+            m_malformed = malformed;
+            m_eof = true;
+            m_not_empty.notify_all();
+        } };
+        return true;
+    }
+
+    void FrameStream::close( void )
+    {
+        {
+            std::lock_guard< std::mutex > lock{ m_mutex };
+            m_stop = true;
+            m_not_full.notify_all();
+        }
+        if ( m_producer.joinable() ) m_producer.join();
+        if ( m_file != nullptr ) std::fclose( m_file );
+        m_file = nullptr;
+    }
+
+    bool FrameStream::push( StreamFrame & frame )
+    {
+        std::unique_lock< std::mutex > lock{ m_mutex };
+        m_not_full.wait( lock, [this]() { return m_stop || m_count < m_ring.size(); } );
+        if ( m_stop ) return false;
+        // Swapping keeps the capacity of both frames: no allocation once the ring is warm.
+        std::swap( m_ring[ ( m_head + m_count ) % m_ring.size() ], frame );
+        m_count += 1;
+        m_not_empty.notify_one();
+        lock.unlock();
+        frame.clear();
+        return true;
+    }
+
+    bool FrameStream::next( BarChart & chart )
+    {
+        {
+            std::unique_lock< std::mutex > lock{ m_mutex };
+            m_not_empty.wait( lock, [this]() { return m_count > 0 || m_eof; } );
+            if ( m_count == 0 ) return false;
+            std::swap( m_current, m_ring[m_head] );
+            m_head = ( m_head + 1 ) % m_ring.size();
+            m_count -= 1;
+            m_not_full.notify_one();
+        }
+
+        // Bring the labels and categories first seen in this frame into the global table.
+        auto & strings = interned();
+        for ( const auto & s : m_current.new_labels ) m_label_map.push_back( strings.labels.intern( s ) );
+        for ( const auto & s : m_current.new_categories ) m_category_map.push_back( strings.categories.intern( s ) );
+
+        chart.clear();
+        for ( std::size_t i{ 0 }; i < m_current.values.size(); ++i )
+            chart.add( m_label_map[ m_current.label_ids[i] ], m_current.values[i], m_category_map[ m_current.category_ids[i] ] );
+        chart.time_stamp = m_current.time;
+        m_delivered += 1;
+        return true;
+    }
+
+    std::size_t FrameStream::malformed( void ) const
+    {
+        std::lock_guard< std::mutex > lock{ m_mutex };
+        return m_malformed;
+    }
+} // namespace bcra.
@@ -0,0 +1,110 @@
+#ifndef FRAME_STREAM_H
+#define FRAME_STREAM_H
+
+/*!
+ * Streaming playback: frames are parsed while the race is running.
+ *
+ * A producer thread reads the input file through a fixed-size buffer and
+ * parses frames ahead into a bounded ring; the animation pops them one at
+ * a time. The first frame is available as soon as it has been read.
+ *
+ * Memory is `capacity` frames plus two copies of each distinct label and
+ * category: one in the global intern table, where bars, tweens and colors
+ * refer to them by id for the whole race, and one in the producer's own
+ * table, which lets it tell new strings from repeated ones without touching
+ * the global table from its thread. Time stamps are not interned; each
+ * frame carries its own. So a long race over a fixed set of labels runs in constant
+ * memory, while a file whose labels never repeat grows with its # of labels.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "barchart.h"
+#include "intern.h"
+#include "loader.h"
+
+namespace bcra {
+    /// One frame travelling from the producer to the animation.
+    struct StreamFrame {
+        std::vector< str_id_t > label_ids;
+        std::vector< value_t > values;
+        std::vector< str_id_t > category_ids;
+        std::string time; //!< Time stamp (assigning keeps the capacity).
+        /// Labels and categories first seen in this frame, in producer id order.
+        std::vector< std::string > new_labels, new_categories;
+
+        void clear( void );
+    };
+
+    /// Reads a dataset frame by frame on a background thread.
+    class FrameStream {
+        public:
+            /// Default # of frames parsed ahead.
+            static constexpr std::size_t default_capacity = 16;
+
+            explicit FrameStream( std::size_t capacity = default_capacity );
+            FrameStream( const FrameStream & ) = delete;
+            FrameStream & operator=( const FrameStream & ) = delete;
+            ~FrameStream() { close(); }
+
+            /// Opens `filename`, reads its header and starts the producer thread.
+            /*!
+             * @param header Receives copies of the three header lines.
+             * @return false, with the reason in `error`, on failure.
+             */
+            bool open( const std::string & filename, const RecordLayout & layout,
+                       std::string header[3], std::string & error );
+            /// Stops the producer and closes the file.
+            void close( void );
+
+            /// Fills `chart` with the next frame, waiting for the producer if needed.
+            /*!
+             * The ids placed in `chart` belong to the global intern table.
+             * @return false when there are no more frames.
+             */
+            bool next( BarChart & chart );
+
+            /// # of frames delivered so far.
+            std::size_t frames_read( void ) const { return m_delivered; }
+            /// # of records skipped by the producer because they could not be parsed.
+            std::size_t malformed( void ) const;
+
+        private:
+            /// Hands `frame` to the ring, waiting for room. Returns false if the stream was closed.
+            bool push( StreamFrame & frame );
+
+            /// Producer-local interning; new strings travel with the frames (the table keeps its own copy).
+            struct LocalTable {
+                StringTable table;
+                str_id_t intern( std::string_view str, std::vector< std::string > & fresh );
+            };
+
+            std::FILE * m_file = nullptr;
+            RecordLayout m_layout;
+            std::thread m_producer;
+
+            //== Ring buffer, guarded by m_mutex.
+            std::vector< StreamFrame > m_ring;
+            std::size_t m_head = 0;  //!< Next slot to pop.
+            std::size_t m_count = 0; //!< # of full slots.
+            bool m_eof = false;      //!< Producer finished.
+            bool m_stop = false;     //!< Consumer asked the producer to quit.
+            std::size_t m_malformed = 0;
+            mutable std::mutex m_mutex;
+            std::condition_variable m_not_empty;
+            std::condition_variable m_not_full;
+
+            //== Consumer side.
+            StreamFrame m_current;                  //!< Frame being consumed (keeps its capacity).
+            std::vector< str_id_t > m_label_map;    //!< Producer id -> global id (one entry per distinct label).
+            std::vector< str_id_t > m_category_map; //!< Same, for categories.
+            std::size_t m_delivered = 0;
+    };
+} // namespace bcra.
+#endif
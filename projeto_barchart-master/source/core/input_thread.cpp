@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "input_thread.h"
+
+namespace bcra {
+
+    InputThread::InputThread()
+        : m_shared{ std::make_shared< Shared >() }
+    { /* empty */ }
+
+    void InputThread::start( void )
+    {
+        if ( m_started ) return;
+        m_started = true;
+        // Detached: a read on the terminal cannot be interrupted, so nobody waits for this thread.
+        std::thread{ [shared = m_shared]() {
+            auto push = [&]( const InputEvent & event ) {
+                while ( !shared->events.push( event ) )
+                    std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } ); // Nobody is reading: hold on.
+            };
+            std::string line;
+            while ( std::getline( std::cin, line ) )
+                push( parse( line ) );
+            push( InputEvent{ input_e::CLOSED, {} } );
+        } }.detach();
+    }
+
+    InputEvent InputThread::parse( const std::string & line )
+    {
+        const auto first = line.find_first_not_of( " \t\r" );
+        if ( first == std::string::npos ) return InputEvent{ input_e::ENTER, {} };
+        const auto last = line.find_last_not_of( " \t\r" );
+        const auto command = line.substr( first, last - first + 1 );
+
+        if ( command == "q" || command == "Q" ) return InputEvent{ input_e::QUIT, {} };
+        if ( command == ">" ) return InputEvent{ input_e::FORWARD, {} };
+        if ( command == "<" ) return InputEvent{ input_e::BACK, {} };
+        if ( command.size() > 2 && ( command[0] == 'g' || command[0] == 'G' ) && ( command[1] == ' ' || command[1] == '\t' ) )
+        {
+            const auto stamp = command.find_first_not_of( " \t", 1 );
+            return InputEvent{ input_e::SEEK, command.substr( stamp ) };
+        }
+        return InputEvent{ input_e::ENTER, {} };
+    }
+
+    bool InputThread::poll( InputEvent & event )
+    {
+        if ( !m_shared->events.pop( event ) ) return false;
+        if ( event.type == input_e::CLOSED ) m_closed = true;
+        return true;
+    }
+
+    InputEvent InputThread::wait( void )
+    {
+        InputEvent event;
+        while ( !m_closed && !poll( event ) )
+            std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } );
+        return event;
+    }
+} // namespace bcra.
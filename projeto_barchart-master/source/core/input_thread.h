@@ -0,0 +1,60 @@
+#ifndef INPUT_THREAD_H
+#define INPUT_THREAD_H
+
+/*!
+ * Keyboard input on its own thread.
+ *
+ * Reading `std::cin` blocks, so it is done by a background thread that turns
+ * each line into an event and pushes it into a lock-free queue. The animation
+ * polls the queue whenever it wants, without ever waiting on the terminal.
+ */
+
+#include <memory>
+#include <string>
+
+#include "../libs/spsc_queue.h"
+
+namespace bcra {
+    /// What the user did.
+    enum class input_e : unsigned char {
+        ENTER = 0, //!< Pressed enter.
+        QUIT,      //!< Typed 'q' and enter.
+        FORWARD,   //!< Typed '>' and enter: jump ahead in the race.
+        BACK,      //!< Typed '<' and enter: jump back in the race.
+        SEEK,      //!< Typed 'g <time stamp>' and enter: jump to that time stamp.
+        CLOSED     //!< The input was closed (end of file); no more events will come.
+    };
+
+    /// An event and its argument.
+    struct InputEvent {
+        input_e type = input_e::CLOSED;
+        std::string time_stamp; //!< Where to jump to, for `SEEK`.
+    };
+
+    /// Reads the standard input from a background thread.
+    class InputThread {
+        public:
+            InputThread();
+
+            /// Starts reading. Call it once.
+            void start( void );
+            /// Takes the oldest pending event, if any. Never blocks.
+            bool poll( InputEvent & event );
+            /// Waits for the next event (`CLOSED` right away once the input was closed).
+            InputEvent wait( void );
+
+            /// Turns a line typed by the user into an event.
+            static InputEvent parse( const std::string & line );
+
+        private:
+            /// What the reader thread shares with the animation. The reader may still be
+            /// blocked on `std::cin` when the program ends, so it keeps its own reference.
+            struct Shared {
+                SpscQueue< InputEvent, 64 > events;
+            };
+            std::shared_ptr< Shared > m_shared;
+            bool m_started = false;
+            bool m_closed = false; //!< `CLOSED` was already handed out.
+    };
+} // namespace bcra.
+#endif
@@ -0,0 +1,41 @@
+#include "intern.h"
+
+namespace bcra {
+
+    InternTable & interned( void )
+    {
+        static InternTable table;
+        return table;
+    }
+
+    str_id_t StringTable::intern( std::string_view str )
+    {
+        auto it = m_ids.find( str );
+        if ( it != m_ids.end() ) return it->second;
+
+        auto id = static_cast<str_id_t>( m_strings.size() );
+        m_strings.emplace_back( str );
+        m_ids.emplace( m_strings.back(), id );
+        return id;
+    }
+
+    str_id_t StringTable::find( std::string_view str ) const
+    {
+        auto it = m_ids.find( str );
+        return it == m_ids.end() ? npos : it->second;
+    }
+
+    std::size_t StringTable::memory_bytes( void ) const
+    {
+        std::size_t bytes{ m_strings.size() * ( sizeof( std::string ) + sizeof( std::string_view ) + sizeof( str_id_t ) ) };
+        for ( const auto & s : m_strings )
+            if ( s.capacity() > sizeof( std::string ) ) bytes += s.capacity(); // Not stored inline (SSO).
+        return bytes;
+    }
+
+    void StringTable::clear( void )
+    {
+        m_ids.clear();
+        m_strings.clear();
+    }
+} // namespace bcra.
@@ -0,0 +1,61 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+/*!
+ * String interning.
+ *
+ * Maps each distinct string to a dense id (0, 1, 2, ...), so that large
+ * datasets can keep 32-bit ids instead of repeating the same labels and
+ * categories over and over.
+ */
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace bcra {
+    /// Dense id of an interned string.
+    using str_id_t = std::uint32_t;
+
+    /// A table of unique strings, each one identified by a dense id.
+    class StringTable {
+        public:
+            /// Returned by `find()` when the string is not in the table.
+            static constexpr str_id_t npos = static_cast<str_id_t>( -1 );
+
+            /// Returns the id of `str`, adding it to the table if needed.
+            str_id_t intern( std::string_view str );
+            /// Returns the id of `str`, or `npos` if it was never interned.
+            str_id_t find( std::string_view str ) const;
+            /// Returns the string with id `id`.
+            std::string_view operator[]( str_id_t id ) const { return m_strings[id]; }
+
+            /// # of distinct strings.
+            std::size_t size( void ) const { return m_strings.size(); }
+            bool empty( void ) const { return m_strings.empty(); }
+            /// Approximated # of bytes held by the table.
+            std::size_t memory_bytes( void ) const;
+            /// Removes all strings.
+            void clear( void );
+
+        private:
+            /// Element addresses in a deque never change, so the map keys can point into it.
+            std::deque< std::string > m_strings;
+            std::unordered_map< std::string_view, str_id_t > m_ids;
+    };
+
+    /// The string tables shared by the whole dataset.
+    struct InternTable {
+        StringTable timestamps; //!< Time stamps of the frames.
+        StringTable labels;     //!< Bar labels.
+        StringTable categories; //!< Bar categories (ids are also color slots).
+
+        void clear( void ) { timestamps.clear(); labels.clear(); categories.clear(); }
+    };
+
+    /// The global intern table.
+    InternTable & interned( void );
+} // namespace bcra.
+#endif
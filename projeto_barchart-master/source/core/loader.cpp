@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "frame_store.h"
+#include "loader.h"
+
+namespace bcra {
+
+    namespace {
+        /// Chunks smaller than this are not worth a thread of their own.
+        constexpr std::size_t min_chunk_bytes = 1 << 20;
+        /// Chunks per thread, so faster threads can pick up the slack of slower ones.
+        constexpr std::size_t chunks_per_thread = 4;
+
+        /// Thread-local interning of views into the input text (only unescaped fields are copied).
+        struct ViewTable {
+            std::unordered_map< std::string_view, str_id_t > ids;
+            std::vector< std::string_view > strings;
+
+            std::deque< std::string > copies; //!< Strings that are not in the input (unescaped fields).
+
+            str_id_t intern( std::string_view str )
+            {
+                auto [it, inserted] = ids.emplace( str, static_cast<str_id_t>( strings.size() ) );
+                if ( inserted ) strings.push_back( str );
+                return it->second;
+            }
+
+            /// Interns field `i` of `fields`, copying it only if it had escaped quotes.
+            str_id_t intern( const Fields & fields, std::size_t i, std::string & scratch )
+            {
+                if ( !fields.escaped_at( i ) ) return intern( fields[i] );
+                const auto str = fields.unescaped( i, scratch );
+                auto it = ids.find( str );
+                return it != ids.end() ? it->second : intern( copies.emplace_back( str ) );
+            }
+        };
+
+        /// The rows of one piece of the input, with ids local to the chunk.
+        struct Chunk {
+            std::string_view text;
+            std::vector< str_id_t > time_ids, label_ids, category_ids;
+            std::vector< value_t > values;
+            std::vector< std::size_t > frame_starts; //!< Local rows where a count line was seen.
+            ViewTable times, labels, categories;
+            std::vector< str_id_t > time_map, label_map, category_map; //!< Local id -> global id.
+            std::size_t malformed = 0;
+            std::size_t first_row = 0;               //!< Global index of the first row.
+        };
+
+        void parse_chunk( Chunk & chunk, const RecordLayout & layout )
+        {
+            DatasetReader reader{ chunk.text, layout.delimiter };
+            Fields fields;
+            std::string scratch;
+            std::size_t count{ 0 };
+            const auto min_fields = layout.min_fields();
+            for ( auto kind = reader.next( fields, count ); kind != DatasetReader::line_e::END; kind = reader.next( fields, count ) )
+            {
+                if ( kind == DatasetReader::line_e::COUNT )
+                {
+                    chunk.frame_starts.push_back( chunk.values.size() );
+                }
+                else if ( kind == DatasetReader::line_e::RECORD )
+                {
+                    value_t value{ 0 };
+                    if ( fields.size() < min_fields || !parse_value( fields[layout.value_idx], value, layout.value_format ) )
+                    {
+                        chunk.malformed += 1;
+                        continue;
+                    }
+                    chunk.time_ids.push_back( chunk.times.intern( fields, layout.date_idx, scratch ) );
+                    chunk.label_ids.push_back( chunk.labels.intern( fields, layout.label_idx, scratch ) );
+                    chunk.values.push_back( value );
+                    chunk.category_ids.push_back( chunk.categories.intern( fields, layout.category_idx, scratch ) );
+                }
+            }
+        }
+
+        /// Runs `task(i)` for every i in [0, n_tasks) on up to `n_threads` threads.
+        template < typename Task >
+        void run_parallel( std::size_t n_tasks, unsigned n_threads, Task && task )
+        {
+            std::atomic< std::size_t > next{ 0 };
+            auto worker = [&]() {
+                for ( auto i = next++; i < n_tasks; i = next++ )
+                    task( i );
+            };
+            std::vector< std::thread > pool;
+            for ( unsigned t{ 1 }; t < n_threads; ++t )
+                pool.emplace_back( worker );
+            worker(); // The calling thread works too.
+            for ( auto & th : pool ) th.join();
+        }
+
+        /// Interns the strings of `local` into `global`, returning the local -> global id map.
+        std::vector< str_id_t > remap( const ViewTable & local, StringTable & global )
+        {
+            std::vector< str_id_t > map;
+            map.reserve( local.strings.size() );
+            for ( auto str : local.strings )
+                map.push_back( global.intern( str ) );
+            return map;
+        }
+    }
+
+    std::size_t RecordLayout::min_fields( void ) const
+    {
+        return 1 + std::max( { date_idx, label_idx, value_idx, category_idx } );
+    }
+
+    DatasetReader::DatasetReader( std::string_view text, char delimiter )
+        : m_text{ text }, m_pos{ 0 }, m_line{ 0 }, m_delimiter{ delimiter }
+    {
+        // Skip the UTF-8 BOM some editors add.
+        if ( m_text.size() >= 3 && std::memcmp( m_text.data(), "\xEF\xBB\xBF", 3 ) == 0 )
+            m_pos = 3;
+    }
+
+    std::string_view DatasetReader::next_line( void )
+    {
+        const char * begin = m_text.data() + m_pos;
+        std::size_t left = m_text.size() - m_pos;
+        const void * nl = std::memchr( begin, '\n', left );
+        std::size_t len = nl ? static_cast<const char *>( nl ) - begin : left;
+        m_pos += nl ? len + 1 : len;
+        ++m_line;
+        return std::string_view{ begin, len };
+    }
+
+    bool DatasetReader::read_header( DatasetHeader & header )
+    {
+        std::string_view * lines[] = { &header.title, &header.value_label, &header.source };
+        for ( auto line : lines )
+        {
+            if ( m_pos >= m_text.size() ) return false;
+            *line = trim( next_line() );
+        }
+        return true;
+    }
+
+    DatasetReader::line_e DatasetReader::next( Fields & fields, std::size_t & count )
+    {
+        if ( m_pos >= m_text.size() ) return line_e::END;
+
+        auto line = trim( next_line() );
+        if ( line.empty() ) return line_e::BLANK;
+
+        if ( line.find( m_delimiter ) == std::string_view::npos )
+        {
+            // A line without delimiters should hold the # of records of the next chart.
+            auto [ptr, ec] = std::from_chars( line.data(), line.data() + line.size(), count );
+            if ( ec == std::errc() && ptr == line.data() + line.size() )
+                return line_e::COUNT;
+        }
+        split_fields( line, m_delimiter, fields );
+        return line_e::RECORD;
+    }
+
+    LoadReport load_records( std::string_view body, const RecordLayout & layout, FrameStore & store, unsigned threads )
+    {
+        LoadReport report;
+        if ( threads == 0 ) threads = std::max( 1u, std::thread::hardware_concurrency() );
+        threads = static_cast<unsigned>( std::clamp< std::size_t >( body.size() / min_chunk_bytes, 1, threads ) );
+        report.threads = threads;
+
+        // Split the body at line boundaries.
+        const std::size_t n_chunks = threads == 1 ? 1 : threads * chunks_per_thread;
+        std::vector< Chunk > chunks( n_chunks );
+        std::size_t start{ 0 };
+        for ( std::size_t i{ 0 }; i < n_chunks; ++i )
+        {
+            std::size_t stop = body.size() * ( i + 1 ) / n_chunks;
+            if ( stop < start ) stop = start;
+            auto nl = body.find( '\n', stop == 0 ? 0 : stop - 1 );
+            stop = ( i + 1 == n_chunks || nl == std::string_view::npos ) ? body.size() : nl + 1;
+            chunks[i].text = body.substr( start, stop - start );
+            start = stop;
+        }
+
+        // Parse every chunk independently.
+        run_parallel( n_chunks, threads, [&]( std::size_t i ) { parse_chunk( chunks[i], layout ); } );
+
+        // Stitch: global ids follow the order of first appearance, exactly as a sequential parse.
+        auto & strings = interned();
+        std::size_t total{ 0 };
+        for ( auto & chunk : chunks )
+        {
+            chunk.time_map = remap( chunk.times, strings.timestamps );
+            chunk.label_map = remap( chunk.labels, strings.labels );
+            chunk.category_map = remap( chunk.categories, strings.categories );
+            chunk.first_row = store.records() + total;
+            total += chunk.values.size();
+            report.malformed += chunk.malformed;
+        }
+
+        auto rows = store.append_rows( total );
+        const auto base = store.records() - total;
+        for ( const auto & chunk : chunks )
+            for ( auto s : chunk.frame_starts )
+                store.begin_frame_at( chunk.first_row + s );
+
+        run_parallel( n_chunks, threads, [&]( std::size_t i ) {
+            auto & chunk = chunks[i];
+            const auto first = chunk.first_row - base;
+            for ( std::size_t r{ 0 }; r < chunk.values.size(); ++r )
+            {
+                rows.time_ids[first + r] = chunk.time_map[ chunk.time_ids[r] ];
+                rows.label_ids[first + r] = chunk.label_map[ chunk.label_ids[r] ];
+                rows.values[first + r] = chunk.values[r];
+                rows.category_ids[first + r] = chunk.category_map[ chunk.category_ids[r] ];
+            }
+            // Release the chunk as soon as it is copied to keep the peak memory down.
+            chunk = Chunk{};
+        } );
+
+        store.finish();
+        return report;
+    }
+} // namespace bcra.
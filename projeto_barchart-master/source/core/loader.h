@@ -0,0 +1,115 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+/*!
+ * Zero-copy reader for bar chart race datasets.
+ *
+ * The reader walks over the raw text of the input file (usually a
+ * `MappedFile`) and hands out `std::string_view`s pointing into it, so
+ * no line or field is ever copied while parsing.
+ *
+ * Expected layout:
+ * ```
+ *   <title>
+ *   <value label>
+ *   <source>
+ *
+ *   <n_bars>
+ *   time_stamp,label,other_info,value,category   (n_bars lines)
+ *
+ *   <n_bars>
+ *   ...
+ * ```
+ */
+
+#include <cstddef>
+#include <string_view>
+
+#include "barchart.h" // value_t
+#include "tokenizer.h"
+#include "value_parser.h"
+
+namespace bcra {
+    class FrameStore;
+
+    /// The three header lines of a dataset, viewed in place.
+    struct DatasetHeader {
+        std::string_view title;       //!< Main title of the race.
+        std::string_view value_label; //!< What the values mean.
+        std::string_view source;      //!< Source of the data.
+    };
+
+    /// Where each piece of information is located inside a record.
+    struct RecordLayout {
+        char delimiter = ',';
+        std::size_t date_idx = 0;     //!< Column of the time stamp.
+        std::size_t label_idx = 1;    //!< Column of the label.
+        std::size_t value_idx = 3;    //!< Column of the value.
+        std::size_t category_idx = 4; //!< Column of the category.
+        ValueFormat value_format;     //!< How the values are written.
+
+        /// # of columns a record needs to have.
+        std::size_t min_fields( void ) const;
+    };
+
+    /// Summary of a `load_records()` call.
+    struct LoadReport {
+        std::size_t malformed = 0; //!< Records skipped because they could not be parsed.
+        unsigned threads = 1;      //!< # of threads actually used.
+    };
+
+
+    /// Sequential, zero-copy reader over the text of a dataset.
+    class DatasetReader {
+        public:
+            /// The kinds of line found after the header.
+            enum class line_e {
+                RECORD = 0, //!< A data line, split into fields.
+                COUNT,      //!< A line with the # of records of the next chart.
+                BLANK,      //!< Separator line.
+                END         //!< No more input.
+            };
+
+            explicit DatasetReader( std::string_view text, char delimiter = ',' );
+
+            /// Reads the three header lines. Returns false if the input is too short.
+            bool read_header( DatasetHeader & header );
+            /// Reads and classifies the next line.
+            /*!
+             * @param fields Receives the fields of a RECORD line.
+             * @param count Receives the number of a COUNT line.
+             * @return The kind of line just read.
+             */
+            line_e next( Fields & fields, std::size_t & count );
+
+            /// # of the last line read (1-based).
+            std::size_t line_number( void ) const { return m_line; }
+            /// Byte offset of the next unread character.
+            std::size_t offset( void ) const { return m_pos; }
+
+        private:
+            /// Returns the next raw line (without the '\n') and advances.
+            std::string_view next_line( void );
+
+            std::string_view m_text; //!< Whole input.
+            std::size_t m_pos;       //!< Current position inside `m_text`.
+            std::size_t m_line;      //!< Lines consumed so far.
+            char m_delimiter;        //!< Field delimiter.
+    };
+
+    /// Parses the body of a dataset (everything after the header) into `store`.
+    /*!
+     * The body is split into chunks at line boundaries, each chunk is parsed
+     * by a worker thread into its own columns and string tables, and then the
+     * chunks are stitched back in order: frames start at the count lines, no
+     * matter which chunk they fall in, and local string ids are remapped into
+     * the global intern table.
+     *
+     * @param body Text following the header.
+     * @param layout Column layout of the records.
+     * @param store Receives the frames; `finish()` is called on it.
+     * @param threads Max # of worker threads (0 means one per core).
+     */
+    LoadReport load_records( std::string_view body, const RecordLayout & layout, FrameStore & store, unsigned threads = 0 );
+} // namespace bcra.
+#endif
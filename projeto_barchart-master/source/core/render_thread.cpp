@@ -0,0 +1,96 @@
+#include "render_thread.h"
+
+namespace bcra {
+
+    RenderThread::RenderThread()
+    {
+        for ( auto & buffer : m_buffers ) m_free.push( &buffer );
+    }
+
+    void RenderThread::start( bool diff, std::size_t rows, std::size_t cols, std::size_t max_cols )
+    {
+        stop();
+        m_diff_mode = diff;
+        m_diff = DiffScreen{ rows, cols, max_cols };
+        m_stop = false;
+        m_thread = std::thread{ [this]() { run(); } };
+    }
+
+    void RenderThread::stop( void )
+    {
+        if ( !m_thread.joinable() ) return;
+        {
+            std::lock_guard< std::mutex > lock{ m_sleep };
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    FrameBuffer * RenderThread::acquire( bool wait )
+    {
+        FrameBuffer * frame{ nullptr };
+        if ( m_free.pop( frame ) ) return frame;
+        if ( !wait )
+        {
+            ++m_skipped;
+            return nullptr;
+        }
+        std::unique_lock< std::mutex > lock{ m_sleep };
+        m_written_cv.wait( lock, [&]() { return m_free.pop( frame ); } );
+        return frame;
+    }
+
+    void RenderThread::submit( FrameBuffer * frame )
+    {
+        if ( !m_thread.joinable() )
+        {
+            // No thread (e.g. before `start()`): write it right here.
+            frame->flush();
+            m_free.push( frame );
+            return;
+        }
+        m_submitted.fetch_add( 1, std::memory_order_relaxed );
+        m_ready.push( frame ); // Never full: there are fewer buffers than slots.
+        {
+            std::lock_guard< std::mutex > lock{ m_sleep };
+        }
+        m_wake.notify_one();
+    }
+
+    void RenderThread::drain( void )
+    {
+        if ( !m_thread.joinable() ) return;
+        std::unique_lock< std::mutex > lock{ m_sleep };
+        m_written_cv.wait( lock, [this]() { return m_written.load() == m_submitted.load(); } );
+    }
+
+    void RenderThread::run( void )
+    {
+        for ( ;; )
+        {
+            FrameBuffer * frame{ nullptr };
+            {
+                std::unique_lock< std::mutex > lock{ m_sleep };
+                m_wake.wait( lock, [&]() { return m_ready.pop( frame ) || m_stop; } );
+            }
+            if ( frame == nullptr ) return; // Stopped with nothing left to write.
+
+            if ( m_diff_mode )
+            {
+                m_diff.render( frame->view(), m_diff_out );
+                frame->clear();
+                m_diff_out.flush();
+            }
+            else
+                frame->flush();
+
+            m_free.push( frame );
+            {
+                std::lock_guard< std::mutex > lock{ m_sleep };
+                m_written.fetch_add( 1 );
+            }
+            m_written_cv.notify_all();
+        }
+    }
+} // namespace bcra.
@@ -0,0 +1,86 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+/*!
+ * Terminal output on its own thread.
+ *
+ * The animation composes each frame into one of a few `FrameBuffer`s and
+ * hands it over; a dedicated thread diffs it against the screen and writes
+ * it out. Buffers travel through two lock-free queues (composed frames one
+ * way, free buffers back), so the animation does not wait on a slow
+ * terminal: when every buffer is still waiting to be written, it skips
+ * drawing that frame. Composing stays on the animation thread, so only the
+ * diff and the write are taken off it; `drain()` (used by the end screen)
+ * is the one place that does wait for the terminal.
+ */
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#include "../libs/spsc_queue.h"
+#include "renderer.h"
+
+namespace bcra {
+    /// Writes composed frames to the standard output from a background thread.
+    class RenderThread {
+        public:
+            /// # of frame buffers: one being composed, one being written and one waiting.
+            static constexpr std::size_t n_buffers = 3;
+
+            RenderThread();
+            RenderThread( const RenderThread & ) = delete;
+            RenderThread & operator=( const RenderThread & ) = delete;
+            ~RenderThread() { stop(); }
+
+            /// Starts the thread. With `diff`, only the cells that changed are repainted.
+            /*!
+             * @param max_cols Width of the terminal (0 if unknown); diffed frames are clipped to it.
+             */
+            void start( bool diff, std::size_t rows, std::size_t cols, std::size_t max_cols = 0 );
+            /// Writes whatever is pending and stops the thread.
+            void stop( void );
+
+            /// A free buffer to compose the next frame in.
+            /*!
+             * @param wait If false, returns `nullptr` (and counts a skipped frame) when every
+             *             buffer is still in flight; if true, waits for one.
+             */
+            FrameBuffer * acquire( bool wait = false );
+            /// Hands a buffer returned by `acquire()` over to be written.
+            void submit( FrameBuffer * frame );
+            /// Waits until every submitted frame has been written.
+            void drain( void );
+
+            /// # of frames not drawn because the terminal was behind.
+            std::size_t skipped( void ) const { return m_skipped; }
+            /// The screen model (only meaningful in diff mode, and after `drain()`).
+            const DiffScreen & screen( void ) const { return m_diff; }
+
+        private:
+            void run( void );
+
+            std::array< FrameBuffer, n_buffers > m_buffers;
+            SpscQueue< FrameBuffer *, 4 > m_ready; //!< Composed frames, oldest first.
+            SpscQueue< FrameBuffer *, 4 > m_free;  //!< Buffers the animation may compose in.
+
+            std::thread m_thread;
+            bool m_diff_mode = false;
+            DiffScreen m_diff{ 0, 0 };
+            FrameBuffer m_diff_out;
+
+            std::atomic< bool > m_stop{ false };
+            std::atomic< std::size_t > m_submitted{ 0 };
+            std::atomic< std::size_t > m_written{ 0 };
+            std::size_t m_skipped = 0;
+
+            //== Only used to sleep while there is nothing to do; the queues themselves take no lock.
+            std::mutex m_sleep;
+            std::condition_variable m_wake;    //!< A frame was submitted (or stop was asked).
+            std::condition_variable m_written_cv; //!< A frame was written.
+    };
+} // namespace bcra.
+#endif
@@ -0,0 +1,244 @@
+#include <iostream>
+
+#ifdef _WIN32
+#  include <fcntl.h>
+#  include <io.h>
+#else
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <sys/ioctl.h>
+#  include <unistd.h>
+#endif
+#include <algorithm>
+
+#include "renderer.h"
+
+namespace bcra {
+
+    bool FrameBuffer::flush( void )
+    {
+        std::cout.flush();
+#ifdef _WIN32
+        return write_to( 1 );
+#else
+        return write_to( STDOUT_FILENO );
+#endif
+    }
+
+    bool FrameBuffer::write_to( int fd )
+    {
+        const char * data = m_buf.data();
+        std::size_t left = m_buf.size();
+        bool ok{ true };
+        // A terminal may take the frame in pieces: keep writing until all of it is out.
+        while ( left > 0 )
+        {
+#ifdef _WIN32
+            auto n = _write( fd, data, static_cast<unsigned>( left ) );
+            if ( n <= 0 ) { ok = false; break; }
+#else
+            auto n = ::write( fd, data, left );
+            if ( n < 0 && errno == EINTR ) continue;
+            if ( n <= 0 ) { ok = false; break; }
+#endif
+            data += n;
+            left -= static_cast<std::size_t>( n );
+        }
+        m_buf.clear();
+        return ok;
+    }
+
+    int open_null_output( void )
+    {
+#ifdef _WIN32
+        return _open( "NUL", _O_WRONLY | _O_BINARY );
+#else
+        return ::open( "/dev/null", O_WRONLY );
+#endif
+    }
+
+    void close_output( int fd )
+    {
+        if ( fd < 0 ) return;
+#ifdef _WIN32
+        _close( fd );
+#else
+        ::close( fd );
+#endif
+    }
+
+    bool stdout_is_terminal( void )
+    {
+#ifdef _WIN32
+        return _isatty( 1 ) != 0;
+#else
+        return ::isatty( STDOUT_FILENO ) != 0;
+#endif
+    }
+
+    std::size_t terminal_columns( void )
+    {
+#if defined( TIOCGWINSZ )
+        winsize size{};
+        if ( ::ioctl( STDOUT_FILENO, TIOCGWINSZ, &size ) == 0 ) return size.ws_col;
+#endif
+        return 0;
+    }
+
+    namespace {
+        /// Gaps of unchanged cells up to this size are repainted instead of jumping over them.
+        constexpr std::size_t max_gap = 4;
+
+        /// Length of the UTF-8 sequence starting with `lead`.
+        std::size_t utf8_length( unsigned char lead )
+        {
+            if ( lead < 0xC0 ) return 1; // ASCII (or a stray continuation byte).
+            if ( lead < 0xE0 ) return 2;
+            if ( lead < 0xF0 ) return 3;
+            return 4;
+        }
+
+        /// Walks over a frame, calling `on_cell( row, col, glyph, sgr )` for each cell.
+        /*!
+         * `sgr` is the parameter list of the last SGR sequence seen (empty after a reset).
+         */
+        template < typename F >
+        void scan( std::string_view frame, F on_cell )
+        {
+            std::size_t row{ 0 }, col{ 0 };
+            std::string_view sgr;
+            for ( std::size_t i{ 0 }; i < frame.size(); )
+            {
+                const auto c = static_cast<unsigned char>( frame[i] );
+                if ( c == '\n' ) { ++row; col = 0; ++i; continue; }
+                if ( c == '\r' ) { col = 0; ++i; continue; }
+                if ( c == 0x1B && i + 1 < frame.size() && frame[i + 1] == '[' )
+                {
+                    // CSI: parameters up to the final byte.
+                    auto end = i + 2;
+                    while ( end < frame.size() && !( frame[end] >= 0x40 && frame[end] <= 0x7E ) ) ++end;
+                    if ( end < frame.size() && frame[end] == 'm' )
+                    {
+                        sgr = frame.substr( i + 2, end - i - 2 );
+                        if ( sgr == "0" ) sgr = {};
+                    }
+                    i = end + 1;
+                    continue;
+                }
+                const auto len = std::min( utf8_length( c ), frame.size() - i );
+                std::uint32_t glyph{ 0 };
+                for ( std::size_t k{ 0 }; k < len; ++k )
+                    glyph |= std::uint32_t{ static_cast<unsigned char>( frame[i + k] ) } << ( 8 * k );
+                on_cell( row, col, glyph, sgr );
+                ++col;
+                i += len;
+            }
+        }
+    }
+
+    DiffScreen::DiffScreen( std::size_t rows, std::size_t cols, std::size_t max_cols )
+        : m_rows{ rows }, m_cols{ max_cols > 0 ? std::min( cols, max_cols ) : cols },
+          m_max_cols{ max_cols > 0 ? max_cols : static_cast<std::size_t>( -1 ) },
+          m_prev( m_rows * m_cols, blank ), m_next( m_rows * m_cols, blank ),
+          m_styles( 1 ) // Style 0 is the terminal default.
+    { /* empty */ }
+
+    std::uint32_t DiffScreen::style_id( std::string_view params )
+    {
+        if ( params.empty() ) return 0;
+        // Only a handful of styles show up in a race, a linear search is the fastest option.
+        for ( std::size_t id{ 1 }; id < m_styles.size(); ++id )
+            if ( m_styles[id] == params ) return static_cast<std::uint32_t>( id );
+        m_styles.emplace_back( params );
+        return static_cast<std::uint32_t>( m_styles.size() - 1 );
+    }
+
+    void DiffScreen::resize( std::size_t rows, std::size_t cols )
+    {
+        std::vector< Cell > prev( rows * cols, blank );
+        for ( std::size_t r{ 0 }; r < m_rows; ++r )
+            std::copy_n( m_prev.begin() + r * m_cols, m_cols, prev.begin() + r * cols );
+        m_prev.swap( prev );
+        m_next.assign( rows * cols, blank );
+        m_rows = rows;
+        m_cols = cols;
+    }
+
+    void DiffScreen::parse( std::string_view frame )
+    {
+        std::size_t rows{ 0 }, cols{ 0 };
+        scan( frame, [&]( std::size_t r, std::size_t c, std::uint32_t, std::string_view ) {
+            rows = std::max( rows, r + 1 );
+            cols = std::max( cols, std::min( c + 1, m_max_cols ) );
+        } );
+        if ( rows > m_rows || cols > m_cols )
+            resize( std::max( rows, m_rows ), std::max( cols, m_cols ) );
+
+        std::fill( m_next.begin(), m_next.end(), blank );
+        scan( frame, [&]( std::size_t r, std::size_t c, std::uint32_t glyph, std::string_view sgr ) {
+            if ( c < m_cols ) m_next[r * m_cols + c] = Cell{ glyph, style_id( sgr ) }; // Clipped to the terminal.
+        } );
+    }
+
+    void DiffScreen::move_to( std::size_t row, std::size_t col, FrameBuffer & out )
+    {
+        if ( row == m_cur_row && col == m_cur_col ) return;
+        out.append( "\33[" ).append_int( static_cast<std::int64_t>( row + 1 ) ).append( ";" )
+           .append_int( static_cast<std::int64_t>( col + 1 ) ).append( "H" );
+        m_cur_row = row;
+        m_cur_col = col;
+    }
+
+    void DiffScreen::emit( const Cell & cell, FrameBuffer & out )
+    {
+        if ( cell.style != m_cur_style )
+        {
+            out.append( "\33[0m" );
+            if ( cell.style != 0 ) out.append( "\33[" ).append( m_styles[cell.style] ).append( "m" );
+            m_cur_style = cell.style;
+        }
+        char bytes[4];
+        std::size_t n{ 0 };
+        for ( auto g = cell.glyph; g != 0 && n < sizeof( bytes ); g >>= 8 ) bytes[n++] = static_cast<char>( g & 0xFF );
+        out.append( std::string_view{ bytes, n } );
+        ++m_cur_col;
+    }
+
+    void DiffScreen::render( std::string_view frame, FrameBuffer & out )
+    {
+        const auto before = out.size();
+        parse( frame );
+        if ( !m_valid )
+        {
+            // Start from a known (blank) screen.
+            out.append( "\33[0m\33[H\33[2J" );
+            std::fill( m_prev.begin(), m_prev.end(), blank );
+            m_cur_row = m_cur_col = 0;
+            m_cur_style = 0;
+            m_valid = true;
+        }
+
+        for ( std::size_t r{ 0 }; r < m_rows; ++r )
+        {
+            const auto * prev = &m_prev[r * m_cols];
+            const auto * next = &m_next[r * m_cols];
+            std::size_t c{ 0 };
+            while ( c < m_cols )
+            {
+                if ( prev[c] == next[c] ) { ++c; continue; }
+                // A run of changed cells, swallowing short gaps of unchanged ones.
+                move_to( r, c, out );
+                std::size_t end{ c };
+                for ( std::size_t k{ c }; k < m_cols && k - end <= max_gap; ++k )
+                    if ( prev[k] != next[k] ) end = k + 1;
+                for ( ; c < end; ++c ) emit( next[c], out );
+            }
+        }
+        if ( m_cur_style != 0 ) { out.append( "\33[0m" ); m_cur_style = 0; }
+        move_to( m_rows, 0, out ); // Anything printed afterwards goes below the chart.
+        m_prev.swap( m_next );
+
+        m_bytes_in += frame.size();
+        m_bytes_out += out.size() - before;
+    }
+} // namespace bcra.
@@ -0,0 +1,178 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+/*!
+ * Frame composition buffer.
+ *
+ * A whole screen is composed in memory and sent to the terminal with a
+ * single `write(2)`, instead of dozens of small (and sometimes flushing)
+ * writes through `std::cout`. The buffer is reused from frame to frame:
+ * once it has grown to the size of the largest frame, composing a frame
+ * does not allocate anymore.
+ *
+ * `DiffScreen` goes one step further: it keeps a model of what is already
+ * on the terminal and turns a composed frame into cursor moves plus the
+ * runs of cells that actually changed.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "value_kernels.h" // bar_steps
+
+namespace bcra {
+    /// Horizontal bar glyphs: `bar_glyphs[k]` is one cell filled k/8 from the left.
+    static constexpr std::string_view bar_glyphs[] = { "", "▏", "▎", "▍", "▌", "▋", "▊", "▉", "█" };
+    /// Reusable output buffer for one frame.
+    class FrameBuffer {
+        public:
+            /// Bytes reserved up front; enough for a regular frame.
+            static constexpr std::size_t default_capacity = 64 * 1024;
+
+            explicit FrameBuffer( std::size_t capacity = default_capacity ) { m_buf.reserve( capacity ); }
+
+            //== Composition.
+            FrameBuffer & append( std::string_view str ) { m_buf.append( str.data(), str.size() ); return *this; }
+            /// Appends `count` copies of `str` (e.g. a multi-byte glyph).
+            FrameBuffer & append( std::string_view str, std::size_t count )
+            {
+                for ( std::size_t i{ 0 }; i < count; ++i ) m_buf.append( str.data(), str.size() );
+                return *this;
+            }
+            /// Appends `count` copies of `c`.
+            FrameBuffer & append( std::size_t count, char c ) { m_buf.append( count, c ); return *this; }
+            /// Appends a bar `eighths`/8 cells long (full blocks plus one partial block).
+            FrameBuffer & append_bar( std::size_t eighths )
+            {
+                append( bar_glyphs[bar_steps], eighths / bar_steps );
+                return append( bar_glyphs[eighths % bar_steps] );
+            }
+            /// Appends `value` in decimal, without going through a stream.
+            FrameBuffer & append_int( std::int64_t value )
+            {
+                char digits[24];
+                auto res = std::to_chars( digits, digits + sizeof( digits ), value );
+                m_buf.append( digits, res.ptr );
+                return *this;
+            }
+
+            /// Appends a fixed-point `value` with `decimals` fractional digits (`12345, 2` -> `123.45`).
+            FrameBuffer & append_fixed( std::int64_t value, unsigned decimals )
+            {
+                if ( decimals == 0 ) return append_int( value );
+                char digits[32];
+                auto res = std::to_chars( digits, digits + sizeof( digits ), value );
+                std::string_view text{ digits, static_cast<std::size_t>( res.ptr - digits ) };
+                if ( value < 0 ) { m_buf.push_back( '-' ); text.remove_prefix( 1 ); }
+                if ( text.size() <= decimals ) m_buf.append( "0." ).append( decimals - text.size(), '0' ).append( text );
+                else m_buf.append( text.substr( 0, text.size() - decimals ) ).append( "." ).append( text.substr( text.size() - decimals ) );
+                return *this;
+            }
+
+            /// The frame composed so far.
+            std::string_view view( void ) const { return m_buf; }
+            std::size_t size( void ) const { return m_buf.size(); }
+            bool empty( void ) const { return m_buf.empty(); }
+            /// Drops the contents, keeping the memory.
+            void clear( void ) { m_buf.clear(); }
+
+            /// Sends the frame to the standard output with one write and clears the buffer.
+            /*!
+             * `std::cout` is flushed first, so anything printed through it comes out
+             * before the frame.
+             * @return false if the output could not be written.
+             */
+            bool flush( void );
+            /// Sends the frame to the file descriptor `fd` and clears the buffer.
+            bool write_to( int fd );
+
+        private:
+            std::string m_buf;
+    };
+
+    /// Returns true if the standard output is a terminal.
+    bool stdout_is_terminal( void );
+    /// Width of the terminal on the standard output, in cells; 0 if unknown (e.g. not a terminal).
+    std::size_t terminal_columns( void );
+    /// Opens the null device for writing. Returns a file descriptor, or -1 on failure.
+    int open_null_output( void );
+    /// Closes a descriptor returned by `open_null_output()`.
+    void close_output( int fd );
+
+    /// Model of the terminal screen, used to repaint only the cells that changed.
+    /*!
+     * Frames are given as plain text, exactly as they would be printed from the
+     * top of the screen: lines split by '\n', UTF-8 text and SGR color sequences
+     * (`ESC [ ... m`). Each code point takes one cell and carries the last SGR
+     * sequence seen before it, which is how `Color::tcolor()` strings behave.
+     *
+     * The grid starts at the size given to the constructor and grows to fit
+     * larger frames, but never wider than the terminal (`max_cols`): cells past
+     * it are clipped. Otherwise a longer line would wrap on the terminal, and
+     * the model (and every later cursor move) would no longer match the screen.
+     * The width is read once; resizing the terminal during the race is not
+     * followed.
+     */
+    class DiffScreen {
+        public:
+            /// A `rows` x `cols` blank screen; `max_cols` is the terminal width (0 = unlimited).
+            DiffScreen( std::size_t rows, std::size_t cols, std::size_t max_cols = 0 );
+
+            /// Appends to `out` the escape sequences that turn the last frame into `frame`.
+            /*!
+             * The first call (and the first after `invalidate()`) clears the screen and
+             * paints everything. The cursor is left on the line below the grid.
+             */
+            void render( std::string_view frame, FrameBuffer & out );
+            /// Forgets what is on the terminal, so the next frame is painted in full.
+            void invalidate( void ) { m_valid = false; }
+
+            std::size_t rows( void ) const { return m_rows; }
+            std::size_t cols( void ) const { return m_cols; }
+            /// # of bytes given to `render()` so far.
+            std::size_t bytes_in( void ) const { return m_bytes_in; }
+            /// # of bytes `render()` emitted so far.
+            std::size_t bytes_out( void ) const { return m_bytes_out; }
+
+        private:
+            /// One screen cell: up to 4 bytes of UTF-8 plus a style id (0 = default).
+            struct Cell {
+                std::uint32_t glyph;
+                std::uint32_t style;
+                bool operator==( const Cell & rhs ) const { return glyph == rhs.glyph && style == rhs.style; }
+                bool operator!=( const Cell & rhs ) const { return !( *this == rhs ); }
+            };
+            static constexpr Cell blank{ ' ', 0 };
+
+            /// Fills `m_next` from `frame`, growing the grid if needed.
+            void parse( std::string_view frame );
+            /// Id of the SGR parameter list `params` ("1;34" for `ESC [ 1 ; 34 m`).
+            std::uint32_t style_id( std::string_view params );
+            void resize( std::size_t rows, std::size_t cols );
+            void move_to( std::size_t row, std::size_t col, FrameBuffer & out );
+            void emit( const Cell & cell, FrameBuffer & out );
+
+            std::size_t m_rows;
+            std::size_t m_cols;
+            std::size_t m_max_cols;              //!< Cells at or past this column are clipped.
+            std::vector< Cell > m_prev;          //!< What the terminal shows (row-major).
+            std::vector< Cell > m_next;          //!< Frame being rendered.
+            std::vector< std::string > m_styles; //!< Style id -> SGR parameters.
+            bool m_valid = false;                //!< False until the screen was cleared and painted once.
+
+            //== Terminal state while emitting.
+            std::size_t m_cur_row = 0;
+            std::size_t m_cur_col = 0;
+            std::uint32_t m_cur_style = 0;
+
+            std::size_t m_bytes_in = 0;
+            std::size_t m_bytes_out = 0;
+    };
+} // namespace bcra.
+#endif
@@ -0,0 +1,258 @@
+#include <cstdint>
+#include <cstring>
+
+#include "../libs/cpu.h"
+#include "tokenizer.h"
+
+namespace bcra {
+
+    namespace {
+        constexpr char quote = '"';
+
+        /// Index of the lowest set bit of `mask` (which is not zero).
+        inline unsigned lowest_bit( std::uint32_t mask )
+        {
+#if defined( _MSC_VER ) && !defined( __clang__ )
+            unsigned long index;
+            _BitScanForward( &index, mask );
+            return static_cast<unsigned>( index );
+#else
+            return static_cast<unsigned>( __builtin_ctz( mask ) );
+#endif
+        }
+
+        /// Turns the positions of delimiters and quotes of a line, in order, into fields.
+        /*!
+         * Every implementation only has to find the candidate positions; what they mean
+         * (field end, opening or closing quote, escaped quote) is decided here.
+         */
+        class Splitter {
+            public:
+                Splitter( std::string_view line, char delimiter, Fields & out )
+                    : m_line{ line }, m_out{ out }, m_quoting{ delimiter != quote }
+                {
+                    m_out.count = 0;
+                    m_out.escaped = 0;
+                }
+
+                /// Handles the delimiter or quote at `i`. Returns false once `Fields` is full.
+                bool at( std::size_t i )
+                {
+                    if ( i < m_skip ) return true;
+                    if ( m_line[i] == quote && m_quoting )
+                    {
+                        if ( m_quoted )
+                        {
+                            if ( i + 1 < m_line.size() && m_line[i + 1] == quote )
+                            {
+                                m_skip = i + 2; // Escaped "".
+                                m_escaped = true;
+                            }
+                            else m_quoted = false;
+                        }
+                        else if ( trim( m_line.substr( m_start, i - m_start ) ).empty() )
+                            m_quoted = true; // Only an opening quote counts; others are plain text.
+                        return true;
+                    }
+                    if ( m_quoted ) return true;
+                    emit( i );
+                    m_start = i + 1;
+                    return m_out.count < Fields::capacity;
+                }
+
+                /// Delimiter at `i`, known to be outside quotes. Returns false once `Fields` is full.
+                bool field_end( std::size_t i )
+                {
+                    emit( i );
+                    m_start = i + 1;
+                    return m_out.count < Fields::capacity;
+                }
+                /// True if the delimiters from `base` on can go straight to `field_end()`.
+                bool plain( std::size_t base ) const { return !m_quoted && m_skip <= base; }
+
+                /// Emits the last field. Returns the # of fields.
+                std::size_t finish( void )
+                {
+                    if ( m_out.count < Fields::capacity ) emit( m_line.size() );
+                    return m_out.count;
+                }
+
+                std::size_t count( void ) const { return m_out.count; }
+
+            private:
+                void emit( std::size_t end )
+                {
+                    auto field = trim( m_line.substr( m_start, end - m_start ) );
+                    if ( m_quoting && field.size() >= 2 && field.front() == quote && field.back() == quote )
+                    {
+                        field = field.substr( 1, field.size() - 2 );
+                        if ( m_escaped ) m_out.escaped |= std::uint32_t{ 1 } << m_out.count;
+                    }
+                    m_escaped = false;
+                    m_out.tokens[m_out.count++] = field;
+                }
+
+                std::string_view m_line;
+                Fields & m_out;
+                bool m_quoting;           //!< Quotes are special (not when they are the delimiter).
+                std::size_t m_start = 0;  //!< First byte of the current field.
+                std::size_t m_skip = 0;   //!< Positions before this one were already handled.
+                bool m_quoted = false;    //!< Inside a quoted field.
+                bool m_escaped = false;   //!< The current field has an escaped quote.
+        };
+
+        /// Positions of the delimiters and of the quotes in a block (bit i = byte `base + i`).
+        struct Masks {
+            std::uint32_t delimiters;
+            std::uint32_t quotes;
+        };
+
+        /// Feeds the positions found in a block to `splitter`. Returns false once `Fields` is full.
+        inline bool feed( Splitter & splitter, std::size_t base, Masks masks )
+        {
+            if ( masks.quotes == 0 && splitter.plain( base ) )
+            {
+                // Common case: no quoting around, every hit ends a field.
+                for ( auto mask = masks.delimiters; mask != 0; mask &= mask - 1 )
+                    if ( !splitter.field_end( base + lowest_bit( mask ) ) ) return false;
+                return true;
+            }
+            for ( auto mask = masks.delimiters | masks.quotes; mask != 0; mask &= mask - 1 )
+                if ( !splitter.at( base + lowest_bit( mask ) ) ) return false;
+            return true;
+        }
+
+#if BCR_X86
+        /// Delimiters and quotes among the 16 bytes at `p`.
+        inline Masks scan_sse2( const char * p, __m128i delimiters, __m128i quotes )
+        {
+            const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) );
+            return Masks{ static_cast<std::uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( bytes, delimiters ) ) ),
+                          static_cast<std::uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( bytes, quotes ) ) ) };
+        }
+
+        /// Delimiters and quotes among the 32 bytes at `p`. (Not a lambda: lambdas do not
+        /// inherit the AVX2 target of the function they are in.)
+        BCR_TARGET_AVX2
+        inline Masks scan_avx2( const char * p, __m256i delimiters, __m256i quotes )
+        {
+            const __m256i bytes = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( p ) );
+            return Masks{ static_cast<std::uint32_t>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( bytes, delimiters ) ) ),
+                          static_cast<std::uint32_t>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( bytes, quotes ) ) ) };
+        }
+
+        /// Drops the bits of the bytes past the end of the line.
+        inline Masks clip( Masks masks, std::size_t valid_bytes )
+        {
+            const std::uint32_t valid = valid_bytes >= 32 ? ~std::uint32_t{ 0 } : ( std::uint32_t{ 1 } << valid_bytes ) - 1;
+            return Masks{ masks.delimiters & valid, masks.quotes & valid };
+        }
+#endif
+
+        using split_fn = std::size_t ( * )( std::string_view, char, Fields & );
+
+        split_fn pick_split( void )
+        {
+            if ( cpu::has_avx2() ) return detail::split_fields_avx2;
+            if ( cpu::has_sse2() ) return detail::split_fields_sse2;
+            return detail::split_fields_scalar;
+        }
+    }
+
+    std::string_view trim( std::string_view str )
+    {
+        std::size_t b{ 0 }, e{ str.size() };
+        while ( b < e && ( str[b] == ' ' || str[b] == '\t' || str[b] == '\r' ) ) ++b;
+        while ( e > b && ( str[e-1] == ' ' || str[e-1] == '\t' || str[e-1] == '\r' ) ) --e;
+        return str.substr( b, e - b );
+    }
+
+    std::string_view Fields::unescaped( std::size_t i, std::string & scratch ) const
+    {
+        if ( !escaped_at( i ) ) return tokens[i];
+        scratch.clear();
+        const auto field = tokens[i];
+        for ( std::size_t c{ 0 }; c < field.size(); ++c )
+        {
+            scratch.push_back( field[c] );
+            if ( field[c] == quote ) ++c; // Keep one quote of each "".
+        }
+        return scratch;
+    }
+
+    std::size_t split_fields( std::string_view line, char delimiter, Fields & out )
+    {
+        static const split_fn split = pick_split();
+        return split( line, delimiter, out );
+    }
+
+    namespace detail {
+        std::size_t split_fields_scalar( std::string_view line, char delimiter, Fields & out )
+        {
+            Splitter splitter{ line, delimiter, out };
+            for ( std::size_t i{ 0 }; i < line.size(); ++i )
+                if ( ( line[i] == delimiter || line[i] == quote ) && !splitter.at( i ) ) return splitter.count();
+            return splitter.finish();
+        }
+
+#if BCR_X86
+        std::size_t split_fields_sse2( std::string_view line, char delimiter, Fields & out )
+        {
+            Splitter splitter{ line, delimiter, out };
+            const __m128i delimiters = _mm_set1_epi8( delimiter );
+            const __m128i quotes = _mm_set1_epi8( quote );
+
+            const char * data = line.data();
+            const std::size_t size = line.size();
+            std::size_t base{ 0 };
+            for ( ; base + 16 <= size; base += 16 )
+                if ( !feed( splitter, base, scan_sse2( data + base, delimiters, quotes ) ) ) return splitter.count();
+            if ( base < size )
+            {
+                // The tail is copied into a zeroed block, so nothing past the line is read.
+                alignas( 16 ) char tail[16] = {};
+                std::memcpy( tail, data + base, size - base );
+                if ( !feed( splitter, base, clip( scan_sse2( tail, delimiters, quotes ), size - base ) ) ) return splitter.count();
+            }
+            return splitter.finish();
+        }
+
+        BCR_TARGET_AVX2
+        std::size_t split_fields_avx2( std::string_view line, char delimiter, Fields & out )
+        {
+            Splitter splitter{ line, delimiter, out };
+            const __m256i delimiters = _mm256_set1_epi8( delimiter );
+            const __m256i quotes = _mm256_set1_epi8( quote );
+
+            const char * data = line.data();
+            const std::size_t size = line.size();
+            std::size_t base{ 0 };
+            for ( ; base + 32 <= size; base += 32 )
+                if ( !feed( splitter, base, scan_avx2( data + base, delimiters, quotes ) ) ) return splitter.count();
+            if ( base < size )
+            {
+                alignas( 32 ) char tail[32] = {};
+                std::memcpy( tail, data + base, size - base );
+                if ( !feed( splitter, base, clip( scan_avx2( tail, delimiters, quotes ), size - base ) ) ) return splitter.count();
+            }
+            return splitter.finish();
+        }
+#else
+        std::size_t split_fields_sse2( std::string_view line, char delimiter, Fields & out )
+        {
+            return split_fields_scalar( line, delimiter, out );
+        }
+
+        std::size_t split_fields_avx2( std::string_view line, char delimiter, Fields & out )
+        {
+            return split_fields_scalar( line, delimiter, out );
+        }
+#endif
+
+        const char * split_fields_isa( void )
+        {
+            const auto split = pick_split();
+            return split == split_fields_avx2 ? "avx2" : split == split_fields_sse2 ? "sse2" : "scalar";
+        }
+    } // namespace detail.
+} // namespace bcra.
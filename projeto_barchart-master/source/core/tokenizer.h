@@ -0,0 +1,63 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+/*!
+ * Allocation-free field splitter for the record lines of a dataset.
+ *
+ * Fields are written as `std::string_view`s into a fixed-capacity `Fields`
+ * array, so splitting a line never allocates. The delimiters are searched
+ * 16 or 32 bytes at a time (SSE2 or AVX2, chosen at run time), with a scalar
+ * path for other CPUs.
+ *
+ * Besides plain fields, CSV quoting is understood:
+ * ```
+ *   1500,"Washington, D.C.",USA,100,North America
+ * ```
+ * A field that starts with `"` runs up to the closing `"`, delimiters
+ * included, and is handed out without the quotes. A doubled `""` inside it
+ * is an escaped quote; since fields are views into the input, it is kept
+ * as `""` in the view, and `Fields::unescaped()` turns it back into `"`
+ * where the field gets copied anyway (when it is interned). Blanks and a
+ * trailing `\r` around fields are dropped.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bcra {
+    /// The fields of a single record line, viewed in place.
+    struct Fields {
+        static constexpr std::size_t capacity = 16; //!< Max # of columns kept per line.
+        std::array< std::string_view, capacity > tokens;
+        std::size_t count = 0;                      //!< # of fields actually found.
+        std::uint32_t escaped = 0;                  //!< Bit i: field i is quoted and has an escaped `""`.
+
+        std::string_view operator[]( std::size_t i ) const { return tokens[i]; }
+        std::size_t size( void ) const { return count; }
+        /// True if field `i` holds escaped quotes, i.e. its view differs from its text.
+        bool escaped_at( std::size_t i ) const { return ( escaped >> i ) & 1u; }
+        /// The text of field `i`: the view itself, or its unescaped copy written to `scratch`.
+        std::string_view unescaped( std::size_t i, std::string & scratch ) const;
+    };
+
+    /// Removes leading and trailing white spaces (including `\r`).
+    std::string_view trim( std::string_view str );
+    /// Splits `line` at `delimiter`, writing the trimmed fields into `out`. Returns # of fields.
+    /*!
+     * Columns past `Fields::capacity` are ignored.
+     */
+    std::size_t split_fields( std::string_view line, char delimiter, Fields & out );
+
+    namespace detail {
+        /// Each implementation of `split_fields()`, for benchmarks and tests.
+        std::size_t split_fields_scalar( std::string_view line, char delimiter, Fields & out );
+        std::size_t split_fields_sse2( std::string_view line, char delimiter, Fields & out );
+        std::size_t split_fields_avx2( std::string_view line, char delimiter, Fields & out );
+        /// Name of the implementation `split_fields()` uses on this machine.
+        const char * split_fields_isa( void );
+    }
+} // namespace bcra.
+#endif
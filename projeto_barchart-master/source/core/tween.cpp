@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <numeric>
+
+#include "tween.h"
+
+namespace bcra {
+
+    std::size_t Tween::add_row( str_id_t label, str_id_t category )
+    {
+        m_label.push_back( label );
+        m_category.push_back( category );
+        m_from_value.push_back( 0.0 );
+        m_to_value.push_back( 0.0 );
+        m_value.push_back( 0.0 );
+        m_from_pos.push_back( 0.0f );
+        m_to_pos.push_back( 0.0f );
+        m_pos.push_back( 0.0f );
+        return m_label.size() - 1;
+    }
+
+    void Tween::reserve_rows( std::size_t n )
+    {
+        if ( m_label.capacity() >= n ) return;
+        m_label.reserve( n );
+        m_category.reserve( n );
+        for ( auto * v : { &m_from_value, &m_to_value, &m_value } ) v->reserve( n );
+        for ( auto * v : { &m_from_pos, &m_to_pos, &m_pos } ) v->reserve( n );
+        m_order.reserve( n );
+    }
+
+    void Tween::retarget( const BarChart & target, std::size_t n_bars )
+    {
+        const bool first = m_label.empty();
+        const float off = static_cast<float>( n_bars ); // Position just below the last bar.
+        m_n_bars = n_bars;
+        // At most the rows on screen plus the ones coming in: reserved once, so transitions do not allocate.
+        reserve_rows( 2 * n_bars );
+        // Same for the tables by label: one entry per label known so far.
+        const auto n_labels = interned().labels.size();
+        if ( m_slot.size() < n_labels ) m_slot.resize( n_labels, 0 );
+        if ( m_stamp.size() < n_labels )
+        {
+            m_stamp.resize( n_labels, 0 );
+            m_last_value.resize( n_labels, 0.0 );
+        }
+
+        // Keep only the rows on screen, starting from where they are now.
+        // (`m_to_pos` is about to be rewritten, so it marks them for a while: -1 = unassigned.)
+        for ( std::size_t k{ 0 }; k < m_visible; ++k ) m_to_pos[ m_order[k] ] = -1.0f;
+        std::size_t kept{ 0 };
+        for ( std::size_t r{ 0 }; r < m_label.size(); ++r )
+        {
+            if ( m_to_pos[r] >= 0.0f ) continue;
+            m_label[kept] = m_label[r];
+            m_category[kept] = m_category[r];
+            m_from_value[kept] = m_value[r];
+            m_from_pos[kept] = m_pos[r];
+            m_to_pos[kept] = -1.0f;
+            ++kept;
+        }
+        for ( auto * v : { &m_from_value, &m_to_value, &m_value } ) v->resize( kept );
+        for ( auto * v : { &m_from_pos, &m_to_pos, &m_pos } ) v->resize( kept );
+        m_label.resize( kept );
+        m_category.resize( kept );
+        for ( std::size_t r{ 0 }; r < kept; ++r )
+        {
+            if ( m_label[r] >= m_slot.size() ) m_slot.resize( m_label[r] + 1, 0 );
+            m_slot[ m_label[r] ] = static_cast<std::uint32_t>( r + 1 );
+        }
+
+        // Bars of the new top: rows that are not on screen yet come in from below,
+        // starting at the value they had in the previous chart.
+        for ( std::size_t i{ 0 }; i < target.ranked_size(); ++i )
+        {
+            const auto & bar = target.ranked( i );
+            if ( bar.label >= m_slot.size() ) m_slot.resize( bar.label + 1, 0 );
+            std::size_t r;
+            if ( m_slot[bar.label] != 0 )
+                r = m_slot[bar.label] - 1;
+            else
+            {
+                r = add_row( bar.label, bar.category );
+                m_slot[bar.label] = static_cast<std::uint32_t>( r + 1 );
+                const bool known = bar.label < m_stamp.size() && m_stamp[bar.label] == m_generation;
+                m_from_value[r] = first ? bar.value : ( known ? m_last_value[bar.label] : 0.0 );
+                m_from_pos[r] = first ? static_cast<float>( i ) : off;
+            }
+            m_category[r] = bar.category;
+            m_to_value[r] = static_cast<double>( bar.value );
+            m_to_pos[r] = static_cast<float>( i );
+        }
+
+        // Remember every value of this chart: it is the starting point of the next transition.
+        ++m_generation;
+        const auto & labels = target.label_ids();
+        const auto & values = target.values();
+        for ( std::size_t i{ 0 }; i < target.size(); ++i )
+        {
+            const auto label = labels[i];
+            if ( label >= m_stamp.size() )
+            {
+                m_stamp.resize( label + 1, 0 );
+                m_last_value.resize( label + 1, 0.0 );
+            }
+            m_stamp[label] = m_generation;
+            m_last_value[label] = static_cast<double>( values[i] );
+        }
+
+        // Rows that dropped out of the top leave through the bottom.
+        for ( std::size_t r{ 0 }; r < m_label.size(); ++r )
+        {
+            m_slot[ m_label[r] ] = 0;
+            if ( m_to_pos[r] >= 0.0f ) continue;
+            const auto label = m_label[r];
+            m_to_value[r] = m_stamp[label] == m_generation ? m_last_value[label] : 0.0;
+            m_to_pos[r] = off;
+        }
+
+        step( first ? 1.0f : 0.0f );
+    }
+
+    void Tween::step( float t )
+    {
+        const auto n = m_label.size();
+        const double tv = t;
+        const float u = 1.0f - t;
+        // Written as a(1-t) + bt, so both ends are exact.
+        for ( std::size_t i{ 0 }; i < n; ++i )
+            m_value[i] = m_from_value[i] * ( 1.0 - tv ) + m_to_value[i] * tv;
+        for ( std::size_t i{ 0 }; i < n; ++i )
+            m_pos[i] = m_from_pos[i] * u + m_to_pos[i] * t;
+
+        m_order.resize( n );
+        std::iota( m_order.begin(), m_order.end(), 0u );
+        std::sort( m_order.begin(), m_order.end(), [this]( std::uint32_t a, std::uint32_t b ) {
+            return m_pos[a] != m_pos[b] ? m_pos[a] < m_pos[b] : m_to_pos[a] < m_to_pos[b];
+        } );
+        const float off = static_cast<float>( m_n_bars );
+        m_visible = 0;
+        while ( m_visible < std::min( n, m_n_bars ) && m_pos[ m_order[m_visible] ] < off ) ++m_visible;
+    }
+} // namespace bcra.
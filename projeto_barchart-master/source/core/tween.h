@@ -0,0 +1,81 @@
+#ifndef TWEEN_H
+#define TWEEN_H
+
+/*!
+ * In-between frames for the race.
+ *
+ * When a new chart arrives, `Tween` sets up a transition from what is on
+ * screen to the new top bars: every row gets a start and an end value and
+ * a start and an end position (rank). `step( t )` then interpolates all
+ * rows at once, so the race can be drawn at any point of the transition.
+ *
+ * Rows are kept as a struct of arrays (one contiguous array per field),
+ * which lets the compiler vectorize the interpolation loops.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "barchart.h"
+#include "intern.h"
+
+namespace bcra {
+    /// Interpolates the bars shown between two consecutive charts.
+    class Tween {
+        public:
+            /// A row ready to be drawn.
+            struct Row {
+                str_id_t label;
+                str_id_t category;
+                value_t value;
+            };
+
+            /// Starts a transition from the current state to the ranked chart `target`.
+            /*!
+             * `target` must have been ranked (`sort()` or `rerank()`). The first call
+             * jumps straight to `target`, as there is nothing to move from.
+             * @param n_bars # of bars on screen; bars leave and enter through position `n_bars`.
+             */
+            void retarget( const BarChart & target, std::size_t n_bars );
+            /// Moves every row to point `t` of the transition (0 = start, 1 = `target`).
+            void step( float t );
+
+            /// # of rows visible at the current point.
+            std::size_t size( void ) const { return m_visible; }
+            /// The `i`-th visible row, from top to bottom.
+            Row row( std::size_t i ) const
+            {
+                const auto r = m_order[i];
+                return Row{ m_label[r], m_category[r], static_cast<value_t>( std::llround( m_value[r] ) ) };
+            }
+
+        private:
+            /// Appends a row and returns its index.
+            std::size_t add_row( str_id_t label, str_id_t category );
+            /// Makes room for `n` rows in every array.
+            void reserve_rows( std::size_t n );
+
+            //== One entry per row (struct of arrays).
+            std::vector< str_id_t > m_label;
+            std::vector< str_id_t > m_category;
+            std::vector< double > m_from_value;
+            std::vector< double > m_to_value;
+            std::vector< double > m_value;  //!< Value at the current point.
+            std::vector< float > m_from_pos;
+            std::vector< float > m_to_pos;
+            std::vector< float > m_pos;     //!< Position at the current point (0 is the top).
+
+            std::vector< std::uint32_t > m_order; //!< Rows sorted by position.
+            std::size_t m_visible = 0;            //!< # of rows of `m_order` on screen.
+            std::size_t m_n_bars = 0;
+
+            //== Values of the last target, by label id (valid where `m_stamp` equals `m_generation`).
+            std::vector< double > m_last_value;
+            std::vector< std::uint32_t > m_stamp;
+            std::uint32_t m_generation = 0;
+            std::vector< std::uint32_t > m_slot;  //!< Scratch: label id -> row + 1 (0 = none).
+    };
+} // namespace bcra.
+#endif
@@ -0,0 +1,162 @@
+#include "../libs/cpu.h"
+#include "value_kernels.h"
+
+namespace bcra {
+
+    namespace {
+        using stats_fn = ValueStats ( * )( const value_t *, std::size_t );
+        using widths_fn = void ( * )( const value_t *, std::size_t, value_t, std::size_t, std::uint32_t * );
+
+        stats_fn pick_stats( void )
+        {
+            return cpu::has_avx2() ? detail::value_stats_avx2 : detail::value_stats_scalar;
+        }
+
+        widths_fn pick_widths( void )
+        {
+            return cpu::has_avx2() ? detail::bar_widths_avx2 : detail::bar_widths_scalar;
+        }
+    }
+
+    ValueStats value_stats( const value_t * values, std::size_t n )
+    {
+        static const stats_fn stats = pick_stats();
+        return stats( values, n );
+    }
+
+    void bar_widths( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths )
+    {
+        static const widths_fn widths = pick_widths();
+        widths( values, n, max, cells, eighths );
+    }
+
+    namespace detail {
+        ValueStats value_stats_scalar( const value_t * values, std::size_t n )
+        {
+            if ( n == 0 ) return ValueStats{};
+            value_t min{ values[0] }, max{ values[0] };
+            std::uint64_t sum{ 0 }; // Unsigned: wrapping around is defined.
+            for ( std::size_t i{ 0 }; i < n; ++i )
+            {
+                min = values[i] < min ? values[i] : min;
+                max = values[i] > max ? values[i] : max;
+                sum += static_cast<std::uint64_t>( values[i] );
+            }
+            return ValueStats{ min, max, static_cast<value_t>( sum ) };
+        }
+
+        void bar_widths_scalar( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths )
+        {
+            for ( std::size_t i{ 0 }; i < n; ++i )
+                eighths[i] = static_cast<std::uint32_t>( bar_eighths( values[i], max, cells ) );
+        }
+
+#if BCR_X86
+        BCR_TARGET_AVX2
+        ValueStats value_stats_avx2( const value_t * values, std::size_t n )
+        {
+            if ( n == 0 ) return ValueStats{};
+            __m256i min = _mm256_set1_epi64x( values[0] );
+            __m256i max = min;
+            __m256i sum = _mm256_setzero_si256();
+            // Two independent sets of accumulators, so consecutive blends do not wait on each other.
+            __m256i min2 = min, max2 = max, sum2 = sum;
+            std::size_t i{ 0 };
+            for ( ; i + 8 <= n; i += 8 )
+            {
+                const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( values + i ) );
+                const __m256i w = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( values + i + 4 ) );
+                min = _mm256_blendv_epi8( min, v, _mm256_cmpgt_epi64( min, v ) );
+                max = _mm256_blendv_epi8( max, v, _mm256_cmpgt_epi64( v, max ) );
+                sum = _mm256_add_epi64( sum, v );
+                min2 = _mm256_blendv_epi8( min2, w, _mm256_cmpgt_epi64( min2, w ) );
+                max2 = _mm256_blendv_epi8( max2, w, _mm256_cmpgt_epi64( w, max2 ) );
+                sum2 = _mm256_add_epi64( sum2, w );
+            }
+            min = _mm256_blendv_epi8( min, min2, _mm256_cmpgt_epi64( min, min2 ) );
+            max = _mm256_blendv_epi8( max, max2, _mm256_cmpgt_epi64( max2, max ) );
+            sum = _mm256_add_epi64( sum, sum2 );
+            alignas( 32 ) value_t lanes_min[4], lanes_max[4], lanes_sum[4];
+            _mm256_store_si256( reinterpret_cast<__m256i *>( lanes_min ), min );
+            _mm256_store_si256( reinterpret_cast<__m256i *>( lanes_max ), max );
+            _mm256_store_si256( reinterpret_cast<__m256i *>( lanes_sum ), sum );
+
+            // The 4 lanes, then the last values.
+            ValueStats stats{ lanes_min[0], lanes_max[0], 0 };
+            std::uint64_t total{ 0 };
+            for ( int k{ 0 }; k < 4; ++k )
+            {
+                stats.min = std::min( stats.min, lanes_min[k] );
+                stats.max = std::max( stats.max, lanes_max[k] );
+                total += static_cast<std::uint64_t>( lanes_sum[k] );
+            }
+            for ( ; i < n; ++i )
+            {
+                stats.min = std::min( stats.min, values[i] );
+                stats.max = std::max( stats.max, values[i] );
+                total += static_cast<std::uint64_t>( values[i] );
+            }
+            stats.sum = static_cast<value_t>( total );
+            return stats;
+        }
+
+        BCR_TARGET_AVX2
+        void bar_widths_avx2( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths )
+        {
+            if ( max <= 0 )
+            {
+                std::fill( eighths, eighths + n, 0u );
+                return;
+            }
+            // Integers below 2^51 in magnitude added to 2^52 + 2^51 land in the mantissa of that
+            // double, exactly: the int64 -> double conversion AVX2 lacks. Other blocks go scalar.
+            const __m256i magic_bits = _mm256_set1_epi64x( 0x4338000000000000ll );
+            const __m256d magic = _mm256_set1_pd( 6755399441055744.0 ); // 2^52 + 2^51.
+            const __m256i limit = _mm256_set1_epi64x( ( 1ll << 51 ) - 1 );
+            const __m256i neg_limit = _mm256_set1_epi64x( -( 1ll << 51 ) );
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256d vmax = _mm256_set1_pd( static_cast<double>( max ) );
+            const __m256d full = _mm256_set1_pd( static_cast<double>( cells * bar_steps ) );
+            const __m256d one = _mm256_set1_pd( 1.0 );
+            const __m256d half = _mm256_set1_pd( 0.5 );
+
+            std::size_t i{ 0 };
+            for ( ; i + 4 <= n; i += 4 )
+            {
+                const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( values + i ) );
+                const __m256i out = _mm256_or_si256( _mm256_cmpgt_epi64( v, limit ), _mm256_cmpgt_epi64( neg_limit, v ) );
+                if ( !_mm256_testz_si256( out, out ) )
+                {
+                    bar_widths_scalar( values + i, 4, max, cells, eighths + i );
+                    continue;
+                }
+                const __m256d d = _mm256_sub_pd( _mm256_castsi256_pd( _mm256_add_epi64( v, magic_bits ) ), magic );
+                // Same operations as bar_eighths(), then llround() as trunc + (fraction >= 0.5).
+                const __m256d x = _mm256_mul_pd( _mm256_div_pd( d, vmax ), full );
+                const __m256d t = _mm256_round_pd( x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+                __m256d steps = _mm256_add_pd( t, _mm256_and_pd( _mm256_cmp_pd( _mm256_sub_pd( x, t ), half, _CMP_GE_OQ ), one ) );
+                steps = _mm256_min_pd( _mm256_max_pd( steps, one ), full );
+                // Values <= 0 get no bar (all bits clear is 0.0).
+                steps = _mm256_and_pd( steps, _mm256_castsi256_pd( _mm256_cmpgt_epi64( v, zero ) ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( eighths + i ), _mm256_cvtpd_epi32( steps ) );
+            }
+            bar_widths_scalar( values + i, n - i, max, cells, eighths + i );
+        }
+#else
+        ValueStats value_stats_avx2( const value_t * values, std::size_t n )
+        {
+            return value_stats_scalar( values, n );
+        }
+
+        void bar_widths_avx2( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths )
+        {
+            bar_widths_scalar( values, n, max, cells, eighths );
+        }
+#endif
+
+        const char * value_kernels_isa( void )
+        {
+            return pick_stats() == value_stats_avx2 ? "avx2" : "scalar";
+        }
+    } // namespace detail.
+} // namespace bcra.
@@ -0,0 +1,58 @@
+#ifndef VALUE_KERNELS_H
+#define VALUE_KERNELS_H
+
+/*!
+ * Kernels over the values of a chart, run for every frame and tween step.
+ *
+ * `value_stats()` finds the min, max and sum of a value array in one pass;
+ * `bar_widths()` turns a value array into bar lengths, in 1/8 cells, in
+ * another. Both have an AVX2 version (4 values per instruction) and a scalar
+ * one, and pick the best for the CPU at run time. They give the same results
+ * bit for bit: the AVX2 widths are rounded exactly like `bar_eighths()`.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "value_parser.h" // value_t
+
+namespace bcra {
+    /// # of steps a bar can grow inside a single cell.
+    static constexpr std::size_t bar_steps = 8;
+
+    /// Length, in 1/8 cells, of the bar for `value` when `max` fills `cells` cells.
+    /*!
+     * Positive values get at least one step, so no bar on screen disappears.
+     */
+    inline std::size_t bar_eighths( std::int64_t value, std::int64_t max, std::size_t cells )
+    {
+        if ( value <= 0 || max <= 0 ) return 0;
+        const auto steps = std::llround( static_cast<double>( value ) / static_cast<double>( max ) * cells * bar_steps );
+        return static_cast<std::size_t>( std::clamp< long long >( steps, 1, static_cast<long long>( cells * bar_steps ) ) );
+    }
+
+    /// Min, max and sum of a value array (all 0 for an empty one).
+    struct ValueStats {
+        value_t min = 0;
+        value_t max = 0;
+        value_t sum = 0; //!< Wraps around past the `value_t` range, like unsigned arithmetic.
+    };
+
+    /// Min, max and sum of the `n` values at `values`.
+    ValueStats value_stats( const value_t * values, std::size_t n );
+    /// Writes into `eighths[i]` the `bar_eighths()` of `values[i]`, for the `n` values.
+    void bar_widths( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths );
+
+    namespace detail {
+        /// Each implementation of the kernels, for benchmarks and tests.
+        ValueStats value_stats_scalar( const value_t * values, std::size_t n );
+        ValueStats value_stats_avx2( const value_t * values, std::size_t n );
+        void bar_widths_scalar( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths );
+        void bar_widths_avx2( const value_t * values, std::size_t n, value_t max, std::size_t cells, std::uint32_t * eighths );
+        /// Name of the implementation the kernels use on this machine.
+        const char * value_kernels_isa( void );
+    }
+} // namespace bcra.
+#endif
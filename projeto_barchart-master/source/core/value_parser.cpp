@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#include "tokenizer.h" // trim()
+#include "value_parser.h"
+
+namespace bcra {
+
+    namespace {
+        constexpr std::uint64_t u64_max = std::numeric_limits< std::uint64_t >::max();
+
+        /// 10^0 .. 10^19, all the powers of ten a `std::uint64_t` holds.
+        constexpr std::uint64_t pow10[20] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+            100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+            10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+            100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull };
+
+        inline bool is_digit( char c ) { return c >= '0' && c <= '9'; }
+
+        /// `acc = acc * 10^n + tail`. Returns false on overflow.
+        inline bool shift_add( std::uint64_t & acc, std::size_t n, std::uint64_t tail )
+        {
+            if ( acc != 0 && ( n >= 20 || acc > u64_max / pow10[n] ) ) return false;
+            acc = ( n >= 20 ? 0 : acc * pow10[n] );
+            if ( acc > u64_max - tail ) return false;
+            acc += tail;
+            return true;
+        }
+
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        constexpr bool swar = false;
+#else
+        constexpr bool swar = true; // The tricks below read the first digit in the lowest byte.
+#endif
+
+        /// True if the 8 bytes of `chunk` are all ASCII digits.
+        inline bool eight_digits( std::uint64_t chunk )
+        {
+            return ( ( chunk & 0xF0F0F0F0F0F0F0F0ull ) == 0x3030303030303030ull )
+                && ( ( ( chunk + 0x0606060606060606ull ) & 0xF0F0F0F0F0F0F0F0ull ) == 0x3030303030303030ull );
+        }
+
+        /// Value of the 8 digits in `chunk`: pairs, then quads, then the whole word, with 3 multiplications.
+        inline std::uint64_t eight_digits_value( std::uint64_t chunk )
+        {
+            chunk -= 0x3030303030303030ull;
+            chunk = chunk * 10 + ( chunk >> 8 );
+            return ( ( ( chunk & 0x000000FF000000FFull ) * ( 100 + ( 1000000ull << 32 ) ) )
+                   + ( ( ( chunk >> 16 ) & 0x000000FF000000FFull ) * ( 1 + ( 10000ull << 32 ) ) ) ) >> 32;
+        }
+
+        constexpr std::size_t npos = static_cast<std::size_t>( -1 );
+
+        /// Appends the run of digits starting at `p` (and ending at `last` at most) to `acc`.
+        /*!
+         * @return # of digits read, with `p` moved past them; `npos` on overflow.
+         */
+        std::size_t read_digits( const char *& p, const char * last, std::uint64_t & acc )
+        {
+            const char * first = p;
+            if ( swar )
+                while ( last - p >= 8 )
+                {
+                    std::uint64_t chunk;
+                    std::memcpy( &chunk, p, sizeof( chunk ) );
+                    if ( !eight_digits( chunk ) ) break;
+                    if ( !shift_add( acc, 8, eight_digits_value( chunk ) ) ) return npos;
+                    p += 8;
+                }
+            // Less than 8 digits left (or no SWAR): the standard conversion.
+            std::uint64_t tail{ 0 };
+            auto [ptr, ec] = std::from_chars( p, last, tail );
+            if ( ec == std::errc::result_out_of_range ) return npos;
+            if ( ec == std::errc() )
+            {
+                if ( !shift_add( acc, static_cast<std::size_t>( ptr - p ), tail ) ) return npos;
+                p = ptr;
+            }
+            return static_cast<std::size_t>( p - first );
+        }
+    }
+
+    bool parse_value( std::string_view str, value_t & value, const ValueFormat & format )
+    {
+        str = trim( str );
+        const char * p = str.data();
+        const char * const last = str.data() + str.size();
+        bool negative{ false };
+        if ( p != last && ( *p == '+' || *p == '-' ) )
+            negative = *p++ == '-';
+
+        // Integer part, digit groups optionally separated by `thousands`:
+        // 1 to 3 digits before the first separator, then exactly 3 after each one.
+        std::uint64_t acc{ 0 };
+        std::size_t n_digits{ 0 };
+        bool grouped{ false };
+        for ( ;; )
+        {
+            const auto n = read_digits( p, last, acc );
+            if ( n == npos || ( grouped && n != 3 ) ) return false;
+            n_digits += n;
+            if ( format.thousands != '\0' && n > 0 && last - p >= 2 && *p == format.thousands && is_digit( p[1] ) )
+            {
+                if ( n > 3 ) return false;
+                grouped = true;
+                ++p;
+                continue;
+            }
+            break;
+        }
+
+        // Fractional part: the first `decimals` digits are kept, the next one rounds.
+        // With no decimals there is no fractional part, so "1.5" is left over and rejected.
+        const unsigned decimals = std::min( format.decimals, ValueFormat::max_decimals );
+        std::size_t kept{ 0 };
+        bool round_up{ false };
+        if ( decimals > 0 && p != last && *p == format.decimal_point )
+        {
+            const char * frac = ++p;
+            while ( p != last && is_digit( *p ) ) ++p;
+            const auto n_frac = static_cast<std::size_t>( p - frac );
+            kept = std::min< std::size_t >( n_frac, decimals );
+            const char * kept_end = frac + kept;
+            if ( read_digits( frac, kept_end, acc ) == npos ) return false;
+            round_up = n_frac > kept && *kept_end >= '5';
+            n_digits += n_frac;
+        }
+        if ( p != last || n_digits == 0 ) return false;
+
+        // Scale to fixed point.
+        if ( !shift_add( acc, decimals - kept, 0 ) ) return false;
+        if ( round_up && !shift_add( acc, 0, 1 ) ) return false;
+
+        constexpr auto max = static_cast<std::uint64_t>( std::numeric_limits< value_t >::max() );
+        if ( negative )
+        {
+            if ( acc > max + 1 ) return false;
+            value = acc == max + 1 ? std::numeric_limits< value_t >::min() : -static_cast<value_t>( acc );
+        }
+        else
+        {
+            if ( acc > max ) return false;
+            value = static_cast<value_t>( acc );
+        }
+        return true;
+    }
+} // namespace bcra.
@@ -0,0 +1,38 @@
+#ifndef VALUE_PARSER_H
+#define VALUE_PARSER_H
+
+/*!
+ * Non-throwing parser for the value column of a dataset.
+ *
+ * Values are 64-bit integers. Besides plain numbers, the parser accepts
+ * thousands separators (every group after one must have exactly 3 digits,
+ * so `"1,23"` is rejected) and, when `decimals > 0`, decimal values, which
+ * are scaled to fixed point: with `decimals = 2`, `"1,234.5"` becomes
+ * `123450` (`"1.005"` rounds to `101`). With `decimals = 0`, `"1.5"` is
+ * not a value. Runs of 8 digits are converted at once with SWAR arithmetic on a
+ * 64-bit word; shorter runs go through `std::from_chars()`.
+ *
+ * Anything else (letters, a value out of the 64-bit range, a lone sign) is
+ * rejected, so the caller can count the record as malformed.
+ */
+
+#include <cstdint>
+#include <string_view>
+
+namespace bcra {
+    // The value type of a data item.
+    using value_t = std::int64_t;
+
+    /// How the numbers of the value column are written.
+    struct ValueFormat {
+        char thousands = '\0';     //!< Thousands separator, skipped between digits ('\0' means none).
+        char decimal_point = '.';  //!< Starts the fractional part.
+        unsigned decimals = 0;     //!< Fractional digits kept: the value is scaled by 10^decimals.
+
+        static constexpr unsigned max_decimals = 9; //!< Largest supported `decimals`.
+    };
+
+    /// Converts `str` into a value. Returns false if `str` is not a number, or does not fit in `value_t`.
+    bool parse_value( std::string_view str, value_t & value, const ValueFormat & format = ValueFormat{} );
+} // namespace bcra.
+#endif
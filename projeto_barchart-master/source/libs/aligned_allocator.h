@@ -0,0 +1,50 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+/*!
+ * Allocator for containers whose storage must start on an `Align`-byte boundary.
+ *
+ * ```c++
+ *      std::vector< double, AlignedAllocator< double, cache_line > > v;
+ * ```
+ * With arrays aligned to a cache line, a loop over them never starts in the
+ * middle of a line, and the compiler can use aligned vector loads.
+ */
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/// Size of a cache line on the machines we care about (x86-64, most ARM64).
+constexpr std::size_t cache_line = 64;
+
+template < typename T, std::size_t Align >
+class AlignedAllocator
+{
+    static_assert( Align >= alignof( T ) && ( Align & ( Align - 1 ) ) == 0, "alignment must be a power of two" );
+
+    public:
+        using value_type = T;
+        template < typename U > struct rebind { using other = AlignedAllocator< U, Align >; };
+
+        AlignedAllocator() noexcept = default;
+        template < typename U > AlignedAllocator( const AlignedAllocator< U, Align > & ) noexcept {}
+
+        T * allocate( std::size_t n )
+        {
+            return static_cast<T *>( ::operator new( n * sizeof( T ), std::align_val_t{ Align } ) );
+        }
+        void deallocate( T * p, std::size_t ) noexcept
+        {
+            ::operator delete( p, std::align_val_t{ Align } );
+        }
+
+        template < typename U > bool operator==( const AlignedAllocator< U, Align > & ) const noexcept { return true; }
+        template < typename U > bool operator!=( const AlignedAllocator< U, Align > & ) const noexcept { return false; }
+};
+
+/// A `std::vector` whose data starts on a cache line.
+template < typename T >
+using aligned_vector = std::vector< T, AlignedAllocator< T, cache_line > >;
+
+#endif
@@ -0,0 +1,72 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.h"
+
+namespace {
+    std::atomic< std::uint64_t > g_allocations{ 0 };
+    thread_local std::uint64_t t_allocations{ 0 };
+
+    void * counted_alloc( std::size_t size, std::size_t alignment )
+    {
+        g_allocations.fetch_add( 1, std::memory_order_relaxed );
+        ++t_allocations;
+        if ( size == 0 ) size = 1;
+        if ( alignment <= alignof( std::max_align_t ) ) return std::malloc( size );
+#ifdef _WIN32
+        return _aligned_malloc( size, alignment );
+#else
+        // aligned_alloc() wants a multiple of the alignment.
+        return std::aligned_alloc( alignment, ( size + alignment - 1 ) / alignment * alignment );
+#endif
+    }
+
+    void * alloc_or_throw( std::size_t size, std::size_t alignment )
+    {
+        for ( ;; )
+        {
+            if ( void * p = counted_alloc( size, alignment ) ) return p;
+            auto handler = std::get_new_handler();
+            if ( handler == nullptr ) throw std::bad_alloc{};
+            handler();
+        }
+    }
+
+    void aligned_free( void * p )
+    {
+#ifdef _WIN32
+        _aligned_free( p );
+#else
+        std::free( p );
+#endif
+    }
+}
+
+std::uint64_t allocation_count( void ) { return g_allocations.load( std::memory_order_relaxed ); }
+std::uint64_t thread_allocation_count( void ) { return t_allocations; }
+
+//== Replacements of the global allocation functions.
+
+void * operator new( std::size_t size ) { return alloc_or_throw( size, 0 ); }
+void * operator new[]( std::size_t size ) { return alloc_or_throw( size, 0 ); }
+void * operator new( std::size_t size, const std::nothrow_t & ) noexcept { return counted_alloc( size, 0 ); }
+void * operator new[]( std::size_t size, const std::nothrow_t & ) noexcept { return counted_alloc( size, 0 ); }
+void * operator new( std::size_t size, std::align_val_t al ) { return alloc_or_throw( size, static_cast<std::size_t>( al ) ); }
+void * operator new[]( std::size_t size, std::align_val_t al ) { return alloc_or_throw( size, static_cast<std::size_t>( al ) ); }
+void * operator new( std::size_t size, std::align_val_t al, const std::nothrow_t & ) noexcept { return counted_alloc( size, static_cast<std::size_t>( al ) ); }
+void * operator new[]( std::size_t size, std::align_val_t al, const std::nothrow_t & ) noexcept { return counted_alloc( size, static_cast<std::size_t>( al ) ); }
+
+void operator delete( void * p ) noexcept { std::free( p ); }
+void operator delete[]( void * p ) noexcept { std::free( p ); }
+void operator delete( void * p, std::size_t ) noexcept { std::free( p ); }
+void operator delete[]( void * p, std::size_t ) noexcept { std::free( p ); }
+void operator delete( void * p, const std::nothrow_t & ) noexcept { std::free( p ); }
+void operator delete[]( void * p, const std::nothrow_t & ) noexcept { std::free( p ); }
+void operator delete( void * p, std::align_val_t ) noexcept { aligned_free( p ); }
+void operator delete[]( void * p, std::align_val_t ) noexcept { aligned_free( p ); }
+void operator delete( void * p, std::size_t, std::align_val_t ) noexcept { aligned_free( p ); }
+void operator delete[]( void * p, std::size_t, std::align_val_t ) noexcept { aligned_free( p ); }
+void operator delete( void * p, std::align_val_t, const std::nothrow_t & ) noexcept { aligned_free( p ); }
+void operator delete[]( void * p, std::align_val_t, const std::nothrow_t & ) noexcept { aligned_free( p ); }
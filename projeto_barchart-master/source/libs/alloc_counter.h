@@ -0,0 +1,20 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+/*!
+ * Counts heap allocations.
+ *
+ * The global `operator new` (all its forms) is replaced by one that bumps a
+ * counter before calling `malloc()`. Comparing two readings tells how many
+ * allocations a piece of code made, e.g. zero for a frame of the race once
+ * it is warmed up.
+ */
+
+#include <cstdint>
+
+/// # of calls to `operator new` made so far by the whole process.
+std::uint64_t allocation_count( void );
+/// # of calls to `operator new` made so far by the calling thread.
+std::uint64_t thread_allocation_count( void );
+
+#endif
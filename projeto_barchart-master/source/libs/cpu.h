@@ -0,0 +1,69 @@
+#ifndef CPU_H
+#define CPU_H
+
+/*!
+ * Runtime detection of the SIMD instruction sets a kernel may use.
+ *
+ * The program is built for the baseline of the target (SSE2 on x86-64), and
+ * wider kernels are compiled separately with `BCR_TARGET_AVX2`. Callers pick
+ * a kernel once, through `cpu::has_avx2()`, so the same binary runs on any
+ * machine of the architecture.
+ * ```c++
+ *      BCR_TARGET_AVX2 void kernel_avx2( ... ) { ... _mm256_... }
+ *      static const auto kernel = cpu::has_avx2() ? kernel_avx2 : kernel_sse2;
+ * ```
+ */
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __i386__ ) || defined( _M_IX86 )
+#   define BCR_X86 1
+#   if defined( _MSC_VER ) && !defined( __clang__ )
+#       include <intrin.h>
+#   endif
+#   include <immintrin.h>
+#else
+#   define BCR_X86 0
+#endif
+
+/// Compiles one function for AVX2, whatever the flags of the rest of the file.
+#if BCR_X86 && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#   define BCR_TARGET_AVX2 __attribute__(( target( "avx2,bmi" ) ))
+#else
+#   define BCR_TARGET_AVX2
+#endif
+
+namespace cpu {
+    /// True if SSE2 can be used (always, on x86-64).
+    inline bool has_sse2( void )
+    {
+#if BCR_X86 && ( defined( __x86_64__ ) || defined( _M_X64 ) )
+        return true;
+#elif BCR_X86 && ( defined( __GNUC__ ) || defined( __clang__ ) )
+        return __builtin_cpu_supports( "sse2" );
+#else
+        return false;
+#endif
+    }
+
+    /// True if AVX2 can be used (the CPU has it and the OS saves the YMM registers).
+    inline bool has_avx2( void )
+    {
+#if BCR_X86 && ( defined( __GNUC__ ) || defined( __clang__ ) )
+        __builtin_cpu_init();
+        return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "bmi" );
+#elif BCR_X86 && defined( _MSC_VER )
+        int regs[4];
+        __cpuid( regs, 0 );
+        if ( regs[0] < 7 ) return false;
+        __cpuid( regs, 1 );
+        const bool osxsave = ( regs[2] & ( 1 << 27 ) ) != 0;
+        const bool avx = ( regs[2] & ( 1 << 28 ) ) != 0;
+        if ( !osxsave || !avx || ( _xgetbv( 0 ) & 0x6 ) != 0x6 ) return false;
+        __cpuidex( regs, 7, 0 );
+        return ( regs[1] & ( 1 << 5 ) ) != 0 && ( regs[1] & ( 1 << 3 ) ) != 0; // AVX2 and BMI1.
+#else
+        return false;
+#endif
+    }
+} // namespace cpu.
+
+#endif
@@ -0,0 +1,144 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <cerrno>
+#  include <cstring>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+MappedFile::MappedFile( MappedFile && other ) noexcept
+{
+    *this = std::move( other );
+}
+
+MappedFile & MappedFile::operator=( MappedFile && other ) noexcept
+{
+    if ( this != &other )
+    {
+        close();
+        m_data = std::exchange( other.m_data, nullptr );
+        m_size = std::exchange( other.m_size, 0 );
+        m_open = std::exchange( other.m_open, false );
+        m_error = std::move( other.m_error );
+#ifdef _WIN32
+        m_file = std::exchange( other.m_file, nullptr );
+        m_mapping = std::exchange( other.m_mapping, nullptr );
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open( const std::string & filename )
+{
+    close();
+    HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        m_error = "nao foi possivel abrir \"" + filename + "\"";
+        return false;
+    }
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( file, &size ) )
+    {
+        CloseHandle( file );
+        m_error = "nao foi possivel obter o tamanho de \"" + filename + "\"";
+        return false;
+    }
+    m_file = file;
+    m_size = static_cast<std::size_t>( size.QuadPart );
+    m_open = true;
+    if ( m_size == 0 ) return true; // Nothing to map.
+
+    HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( mapping == nullptr )
+    {
+        close();
+        m_error = "nao foi possivel mapear \"" + filename + "\"";
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = static_cast<const char *>( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+    if ( m_data == nullptr )
+    {
+        close();
+        m_error = "nao foi possivel mapear \"" + filename + "\"";
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if ( m_data != nullptr ) UnmapViewOfFile( m_data );
+    if ( m_mapping != nullptr ) CloseHandle( static_cast<HANDLE>( m_mapping ) );
+    if ( m_file != nullptr ) CloseHandle( static_cast<HANDLE>( m_file ) );
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#else
+
+bool MappedFile::open( const std::string & filename )
+{
+    close();
+    int fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        m_error = "nao foi possivel abrir \"" + filename + "\": " + std::strerror( errno );
+        return false;
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 )
+    {
+        m_error = "nao foi possivel obter o tamanho de \"" + filename + "\": " + std::strerror( errno );
+        ::close( fd );
+        return false;
+    }
+    m_size = static_cast<std::size_t>( st.st_size );
+    m_open = true;
+    if ( m_size == 0 ) // mmap() rejects empty mappings.
+    {
+        ::close( fd );
+        return true;
+    }
+
+    void * addr = mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd ); // The mapping keeps its own reference to the file.
+    if ( addr == MAP_FAILED )
+    {
+        m_size = 0;
+        m_open = false;
+        m_error = "nao foi possivel mapear \"" + filename + "\": " + std::strerror( errno );
+        return false;
+    }
+    // The loaders read the file front to back, so let the kernel read ahead aggressively.
+    madvise( addr, m_size, MADV_SEQUENTIAL );
+    m_data = static_cast<const char *>( addr );
+    return true;
+}
+
+void MappedFile::close()
+{
+    if ( m_data != nullptr ) munmap( const_cast<char *>( m_data ), m_size );
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
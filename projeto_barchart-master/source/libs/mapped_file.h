@@ -0,0 +1,50 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+/*!
+ * Read-only memory mapping of a whole file.
+ *
+ * The contents are exposed as a `std::string_view`, so parsers can work
+ * directly on the pages the OS brings in, without copying them into a
+ * `std::string` first.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile
+{
+    public:
+        MappedFile() = default;
+        MappedFile( const MappedFile & ) = delete;
+        MappedFile & operator=( const MappedFile & ) = delete;
+        MappedFile( MappedFile && other ) noexcept;
+        MappedFile & operator=( MappedFile && other ) noexcept;
+        ~MappedFile() { close(); }
+
+        /// Maps the file `filename`. Returns false (and fills `error()`) on failure.
+        bool open( const std::string & filename );
+        /// Unmaps the file, if any.
+        void close();
+
+        /// The whole file contents.
+        std::string_view view( void ) const { return std::string_view{ m_data, m_size }; }
+        const char * data( void ) const { return m_data; }
+        std::size_t size( void ) const { return m_size; }
+        bool is_open( void ) const { return m_open; }
+        /// Reason of the last failed `open()`.
+        const std::string & error( void ) const { return m_error; }
+
+    private:
+        const char * m_data = nullptr; //!< First byte of the mapping.
+        std::size_t m_size = 0;        //!< Size of the file in bytes.
+        bool m_open = false;           //!< True while a file is mapped (even an empty one).
+        std::string m_error;           //!< Last error message.
+#ifdef _WIN32
+        void * m_file = nullptr;       //!< HANDLE of the file.
+        void * m_mapping = nullptr;    //!< HANDLE of the file mapping object.
+#endif
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "proc_stats.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#  include <psapi.h>
+#  pragma comment( lib, "psapi" )
+#else
+#  include <sys/resource.h>
+#endif
+
+std::size_t peak_rss_bytes( void )
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if ( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) ) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 ) return 0;
+#  ifdef __APPLE__
+    return static_cast<std::size_t>( usage.ru_maxrss );        // Already in bytes.
+#  else
+    return static_cast<std::size_t>( usage.ru_maxrss ) * 1024; // Kilobytes on Linux.
+#  endif
+#endif
+}
@@ -0,0 +1,13 @@
+#ifndef PROC_STATS_H
+#define PROC_STATS_H
+
+/*!
+ * Resource usage of the running process.
+ */
+
+#include <cstddef>
+
+/// Largest resident set size the process has had so far, in bytes (0 if unknown).
+std::size_t peak_rss_bytes( void );
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+/*!
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * ```c++
+ *      SpscQueue< int, 64 > q;
+ *      q.push( 42 );          // producer thread
+ *      int v;
+ *      if ( q.pop( v ) ) ...  // consumer thread
+ * ```
+ * Neither side ever blocks: `push()` fails when the queue is full and `pop()`
+ * when it is empty.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+template < typename T, std::size_t N >
+class SpscQueue
+{
+    static_assert( N >= 2 && ( N & ( N - 1 ) ) == 0, "capacity must be a power of two" );
+
+    public:
+        /// Adds `value` at the back. Returns false if the queue is full. Producer only.
+        bool push( const T & value )
+        {
+            const auto tail = m_tail.load( std::memory_order_relaxed );
+            if ( tail - m_head.load( std::memory_order_acquire ) == N ) return false;
+            m_items[tail & ( N - 1 )] = value;
+            m_tail.store( tail + 1, std::memory_order_release );
+            return true;
+        }
+
+        /// Takes the front item into `value`. Returns false if the queue is empty. Consumer only.
+        bool pop( T & value )
+        {
+            const auto head = m_head.load( std::memory_order_relaxed );
+            if ( head == m_tail.load( std::memory_order_acquire ) ) return false;
+            value = m_items[head & ( N - 1 )];
+            m_head.store( head + 1, std::memory_order_release );
+            return true;
+        }
+
+        /// True if there is nothing to pop (may be stale by the time it returns).
+        bool empty( void ) const
+        {
+            return m_head.load( std::memory_order_acquire ) == m_tail.load( std::memory_order_acquire );
+        }
+
+    private:
+        // Head and tail live on separate cache lines, so each side only writes its own.
+        alignas( 64 ) std::atomic< std::size_t > m_head{ 0 }; //!< Next item to pop.
+        alignas( 64 ) std::atomic< std::size_t > m_tail{ 0 }; //!< Next free slot.
+        std::array< T, N > m_items{};
+};
+#endif
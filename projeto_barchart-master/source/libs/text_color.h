@@ -11,6 +11,13 @@
  *                << Color::tcolor("texto em vermelho e negrito", Color::RED, Color::BOLD)
  *                << "\n";
  * ```
+ *
+ * When composing a whole screen, `Color::append()` writes the same thing
+ * straight into an output buffer, with escape sequences taken from a table
+ * built at compile time (no stream, no temporary string):
+ * ```c++
+ *      Color::append( buffer, "texto em azul", Color::BLUE, Color::BOLD );
+ * ```
  */
 #include <sstream>
 using std::ostringstream;
@@ -18,6 +25,7 @@ using std::ostringstream;
 using std::string;
 #include <array>
 using std::array;
+#include <string_view>
 
 namespace Color {
     // Alias
@@ -52,17 +60,104 @@ namespace Color {
         31, 32, 33, 34, 35, 36, 37,
         91, 92, 93, 94, 95, 96, 97};
 
+    /// Escape sequence that turns a color/modifier pair on.
+    struct Sgr {
+        char bytes[12] = {}; //!< "\33[" + modifier + ";" + color + "m", at most 10 bytes.
+        unsigned char size = 0;
+        constexpr std::string_view view( void ) const { return std::string_view{ bytes, size }; }
+    };
+
+    /// Sequence that turns colors and modifiers off.
+    static constexpr std::string_view reset{ "\33[0m" };
+
+    /// Modifiers with a precomputed sequence, in table order.
+    static constexpr array< value_t, 5 > modifier_list{ REGULAR, BOLD, UNDERLINE, BLINK, REVERSE };
+
+    namespace detail {
+        constexpr Sgr make_sgr( value_t modifier, value_t color )
+        {
+            Sgr sgr;
+            auto put = [&sgr]( char c ) { sgr.bytes[sgr.size++] = c; };
+            auto put_num = [&put]( value_t n ) {
+                if ( n >= 10 ) put( static_cast<char>( '0' + n / 10 ) );
+                put( static_cast<char>( '0' + n % 10 ) );
+            };
+            put( '\33' ); put( '[' );
+            put_num( modifier );
+            put( ';' );
+            put_num( color );
+            put( 'm' );
+            return sgr;
+        }
+
+        /// Position of `color` in the table: 30..37 -> 0..7, 90..97 -> 8..15, anything else -> -1.
+        constexpr int color_index( value_t color )
+        {
+            if ( color >= BLACK && color <= WHITE ) return color - BLACK;
+            if ( color >= BRIGHT_BLACK && color <= BRIGHT_WHITE ) return color - BRIGHT_BLACK + 8;
+            return -1;
+        }
+
+        constexpr int modifier_index( value_t modifier )
+        {
+            for ( std::size_t i{ 0 }; i < modifier_list.size(); ++i )
+                if ( modifier_list[i] == modifier ) return static_cast<int>( i );
+            return -1;
+        }
+
+        using SgrTable = array< array< Sgr, 16 >, modifier_list.size() >;
+
+        constexpr SgrTable make_table( void )
+        {
+            SgrTable table{};
+            for ( std::size_t m{ 0 }; m < modifier_list.size(); ++m )
+                for ( value_t i{ 0 }; i < 16; ++i )
+                    table[m][i] = make_sgr( modifier_list[m], static_cast<value_t>( i < 8 ? BLACK + i : BRIGHT_BLACK + i - 8 ) );
+            return table;
+        }
+
+        /// Every color/modifier sequence, built by the compiler.
+        static constexpr SgrTable sgr_table = make_table();
+    }
+
+    /// Returns the escape sequence that turns `color` and `modifier` on.
+    /*!
+     * Codes outside the tables above fall back to regular white.
+     */
+    constexpr std::string_view prefix( value_t color = WHITE, value_t modifier = REGULAR )
+    {
+        const int c = detail::color_index( color );
+        const int m = detail::modifier_index( modifier );
+        return detail::sgr_table[ m < 0 ? 0 : m ][ c < 0 ? detail::color_index( WHITE ) : c ].view();
+    }
+
+    /// Appends a colored message to `out` (anything with `append( std::string_view )`).
+    /*!
+     * Same output as `tcolor()`, but nothing is allocated besides what `out` may need to grow.
+     * Unknown color or modifier codes fall back to regular white, as in `prefix()`.
+     * @return `out`.
+     */
+    template < typename Buffer >
+    Buffer & append( Buffer & out, std::string_view msg, value_t color = WHITE, value_t modifier = REGULAR )
+    {
+        out.append( prefix( color, modifier ) );
+        out.append( msg );
+        out.append( reset );
+        return out;
+    }
+
     /// Returns a string with a colored message.
     /*!
      * @param msg Message to display.
-     * @param color Color code to apply to the message.
-     * @param modifier Modifier code to apply to the message.
+     * @param color Color code to apply to the message; unknown codes silently become white.
+     * @param modifier Modifier code to apply to the message; unknown codes silently become regular.
      * @return A string with the embedded color/modifier escape codes.
      */
-    inline string tcolor( const string & msg, short color=Color::WHITE, short modifier=Color::REGULAR ){
-        ostringstream oss;
-        oss << "\33[" << modifier << ";" << color << "m" << msg << "\33[0m";
-        return oss.str();
+    inline string tcolor( std::string_view msg, short color=Color::WHITE, short modifier=Color::REGULAR ){
+        string str;
+        str.reserve( prefix( color, modifier ).size() + msg.size() + reset.size() );
+        append( str, msg, color, modifier );
+        return str; // Returning the local (not append()'s reference) lets it be moved out.
     }
 }
 #endif
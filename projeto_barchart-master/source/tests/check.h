@@ -0,0 +1,37 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+/*!
+ * Bare-bones assertions for the unit tests.
+ *
+ * `CHECK( cond )` reports a failed condition with its file and line and
+ * keeps going, so one run lists every failure. `check::report()` prints the
+ * total and is what a test's `main()` returns: 0 if every check passed.
+ */
+
+#include <iostream>
+
+namespace check {
+    inline int & failures( void )
+    {
+        static int count{ 0 };
+        return count;
+    }
+
+    inline int report( void )
+    {
+        if ( failures() ) std::cerr << failures() << " check(s) failed\n";
+        return failures() == 0 ? 0 : 1;
+    }
+} // namespace check.
+
+#define CHECK( cond )                                                                      \
+    do {                                                                                   \
+        if ( !( cond ) )                                                                   \
+        {                                                                                  \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK( " #cond " ) failed\n";  \
+            ++check::failures();                                                           \
+        }                                                                                  \
+    } while ( 0 )
+
+#endif
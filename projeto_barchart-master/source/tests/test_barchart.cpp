@@ -0,0 +1,61 @@
+/*!
+ * Ranking: `rerank()` must give the same top bars as `sort()` on the first
+ * frame, on frames that changed a little or a lot, and after `reset_rank()`,
+ * with ties broken by label id.
+ */
+
+#include <random>
+
+#include "check.h"
+
+#include "barchart.h"
+
+using namespace bcra;
+
+namespace {
+    /// True if the last ranking of `a` and the `sort()` of `b` list the same bars.
+    bool same_rank( const BarChart & a, BarChart & b, std::size_t top_n )
+    {
+        b.sort( top_n );
+        if ( a.ranked_size() != b.ranked_size() ) return false;
+        for ( std::size_t i{ 0 }; i < a.ranked_size(); ++i )
+            if ( a.ranked( i ).label != b.ranked( i ).label || a.ranked( i ).value != b.ranked( i ).value ) return false;
+        return true;
+    }
+}
+
+int main( void )
+{
+    constexpr std::size_t top_n = 15;
+    std::mt19937 rng{ 20240601u };
+    for ( std::size_t n : { 0, 1, 10, 100, 5000 } )
+    {
+        BarChart chart, reference;
+        for ( str_id_t label{ 0 }; label < n; ++label )
+        {
+            const auto value = static_cast<value_t>( rng() % 50 ); // Few values: lots of ties.
+            chart.add( label, value, 0 );
+            reference.add( label, value, 0 );
+        }
+        chart.rerank( top_n ); // No previous order: seeded.
+        CHECK( chart.rank_moves() == 0 );
+        CHECK( same_rank( chart, reference, top_n ) );
+
+        for ( int frame{ 0 }; frame < 20 && n > 0; ++frame )
+        {
+            // Small changes most frames, a reshuffle every few, a seek now and then.
+            const std::size_t changes = frame % 5 == 4 ? n : n / 20 + 1;
+            for ( std::size_t c{ 0 }; c < changes; ++c )
+            {
+                const auto i = rng() % n;
+                const auto value = static_cast<value_t>( rng() % 50 );
+                chart.set_value( i, value );
+                reference.set_value( i, value );
+            }
+            if ( frame % 7 == 6 ) chart.reset_rank();
+            chart.rerank( top_n );
+            CHECK( same_rank( chart, reference, top_n ) );
+        }
+    }
+    return check::report();
+}
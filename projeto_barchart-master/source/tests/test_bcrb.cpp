@@ -0,0 +1,138 @@
+/*!
+ * `.bcrb` loading: a valid file round-trips, and corrupted ones (truncated,
+ * ids outside the string tables, bad or empty frames, absurd row counts) are
+ * rejected instead of being read out of bounds.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "check.h"
+
+#include "bcrb.h"
+#include "frame_store.h"
+#include "intern.h"
+#include "loader.h"
+#include "mapped_file.h"
+
+using namespace bcra;
+
+namespace {
+    const std::string path{ "test_bcrb.bcrb" };
+
+    // Byte offsets inside the file (see the layout in bcrb.h).
+    constexpr std::size_t n_rows_at = 16;     //!< FileHeader::n_rows.
+    constexpr std::size_t sections_at = 64;   //!< First SectionEntry.
+    constexpr std::size_t label_ids = 7;      //!< Section # of the label ids.
+    constexpr std::size_t frame_offsets = 10; //!< Section # of the frame offsets.
+
+    std::string read_all( void )
+    {
+        std::ifstream in{ path, std::ios::binary };
+        return { std::istreambuf_iterator< char >{ in }, std::istreambuf_iterator< char >{} };
+    }
+
+    void write_all( const std::string & bytes )
+    {
+        std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+        out.write( bytes.data(), static_cast<std::streamsize>( bytes.size() ) );
+    }
+
+    std::uint64_t section_offset( const std::string & bytes, std::size_t section )
+    {
+        std::uint64_t offset;
+        std::memcpy( &offset, bytes.data() + sections_at + section * 16, sizeof( offset ) );
+        return offset;
+    }
+
+    template < typename T >
+    void poke( std::string & bytes, std::size_t at, T value )
+    {
+        std::memcpy( &bytes[at], &value, sizeof( value ) );
+    }
+
+    /// Loads `bytes` as a `.bcrb` file into a fresh store and intern table.
+    bool load( const std::string & bytes, FrameStore & store )
+    {
+        write_all( bytes );
+        interned().clear();
+        MappedFile file;
+        if ( !file.open( path ) ) return false;
+        DatasetHeader header;
+        unsigned decimals{ 0 };
+        std::string error;
+        return bcrb::load( std::move( file ), header, decimals, store, error ) && decimals == 2;
+    }
+}
+
+int main( void )
+{
+    // Two frames, three labels, two categories.
+    {
+        FrameStore store;
+        store.begin_frame();
+        store.add( "2000", "Rio", 10, "BR" );
+        store.add( "2000", "Lima", 7, "PE" );
+        store.begin_frame();
+        store.add( "2001", "Rio", 12, "BR" );
+        store.add( "2001", "Natal", 9, "BR" );
+        store.finish();
+        DatasetHeader header{ "Cities", "Population", "Census" };
+        std::string error;
+        CHECK( bcrb::save( path, header, 2, store, error ) );
+    }
+    const auto good = read_all();
+    CHECK( good.size() > sections_at );
+
+    {
+        FrameStore store;
+        CHECK( load( good, store ) );
+        CHECK( store.frames() == 2 );
+        CHECK( store.records() == 4 );
+        CHECK( store.frame_time( 1 ) == "2001" );
+    }
+    {
+        FrameStore store;
+        CHECK( !load( good.substr( 0, good.size() / 2 ), store ) );
+        CHECK( !load( good.substr( 0, 100 ), store ) );
+    }
+    {
+        auto bytes = good;
+        poke< std::uint32_t >( bytes, section_offset( bytes, label_ids ), 3 ); // Only 3 labels: ids 0..2.
+        FrameStore store;
+        CHECK( !load( bytes, store ) );
+    }
+    {
+        auto bytes = good;
+        poke< std::uint64_t >( bytes, section_offset( bytes, frame_offsets ), 1 ); // offsets[0] != 0.
+        FrameStore store;
+        CHECK( !load( bytes, store ) );
+    }
+    {
+        auto bytes = good;
+        poke< std::uint64_t >( bytes, section_offset( bytes, frame_offsets ) + 2 * 8, 3 ); // offsets.back() != n_rows.
+        FrameStore store;
+        CHECK( !load( bytes, store ) );
+    }
+    {
+        auto bytes = good;
+        poke< std::uint64_t >( bytes, section_offset( bytes, frame_offsets ) + 8, 4 ); // Offsets [0,4,4]: frame 1 is empty.
+        FrameStore store;
+        CHECK( !load( bytes, store ) );
+        poke< std::uint64_t >( bytes, section_offset( bytes, frame_offsets ) + 8, 0 ); // Offsets [0,0,4]: frame 0 is empty.
+        CHECK( !load( bytes, store ) );
+    }
+    {
+        auto bytes = good;
+        poke< std::uint64_t >( bytes, n_rows_at, std::uint64_t{ 1 } << 62 ); // n_rows * 8 would overflow.
+        FrameStore store;
+        CHECK( !load( bytes, store ) );
+    }
+
+    std::remove( path.c_str() );
+    return check::report();
+}
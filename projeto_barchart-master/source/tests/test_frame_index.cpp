@@ -0,0 +1,110 @@
+/*!
+ * `FrameIndex`: the comparison rule chosen per dataset, and
+ * `first_at_or_after()` / `end_at_or_before()` on ordered, unordered and
+ * out-of-range stamps.
+ */
+
+#include <initializer_list>
+#include <string>
+
+#include "check.h"
+
+#include "frame_index.h"
+#include "frame_store.h"
+#include "intern.h"
+
+using namespace bcra;
+
+namespace {
+    /// Fills `store` with one single-bar frame per stamp.
+    void make_frames( FrameStore & store, std::initializer_list< const char * > stamps )
+    {
+        store.clear();
+        interned().clear();
+        for ( auto stamp : stamps )
+        {
+            store.begin_frame();
+            store.add( stamp, "a", 1, "c" );
+        }
+        store.finish();
+    }
+}
+
+int main( void )
+{
+    constexpr auto npos = FrameIndex::npos;
+    FrameStore store;
+    FrameIndex index;
+
+    // Ordered integers, compared as numbers ("999" < "1000"), with a repeated stamp.
+    make_frames( store, { "998", "999", "1000", "1000", "1002" } );
+    index.build( store );
+    CHECK( index.frames() == 5 );
+    CHECK( index.numeric() );
+    CHECK( index.ordered() );
+    CHECK( index.first_at_or_after( "999" ) == 1 );
+    CHECK( index.first_at_or_after( "1000" ) == 2 );
+    CHECK( index.first_at_or_after( "1001" ) == 4 );  // Between two stamps.
+    CHECK( index.first_at_or_after( "0998" ) == 0 );  // Leading zeros do not matter.
+    CHECK( index.end_at_or_before( "1000" ) == 4 );
+    CHECK( index.end_at_or_before( "1001" ) == 4 );
+    CHECK( index.end_at_or_before( "998" ) == 1 );
+    // Out of range.
+    CHECK( index.first_at_or_after( "-5" ) == 0 );
+    CHECK( index.first_at_or_after( "5000" ) == 5 );
+    CHECK( index.end_at_or_before( "-5" ) == 0 );
+    CHECK( index.end_at_or_before( "5000" ) == 5 );
+    // Not a number: not comparable with numeric stamps.
+    CHECK( index.first_at_or_after( "1000-01" ) == npos );
+    CHECK( index.end_at_or_before( "abc" ) == npos );
+
+    // Negative years.
+    make_frames( store, { "-300", "-20", "0", "15" } );
+    index.build( store );
+    CHECK( index.numeric() );
+    CHECK( index.ordered() );
+    CHECK( index.first_at_or_after( "-100" ) == 1 );
+    CHECK( index.end_at_or_before( "-1" ) == 2 );
+
+    // ISO dates: text.
+    make_frames( store, { "2020-01-05", "2020-02-01", "2020-10-01" } );
+    index.build( store );
+    CHECK( !index.numeric() );
+    CHECK( index.ordered() );
+    CHECK( index.first_at_or_after( "2020-01-31" ) == 1 );
+    CHECK( index.end_at_or_before( "2020-09-30" ) == 2 );
+    CHECK( index.first_at_or_after( "2019" ) == 0 );
+    CHECK( index.end_at_or_before( "2021" ) == 3 );
+
+    // Mixed stamps: one non-integer makes the whole dataset text, so "999" > "1000".
+    make_frames( store, { "1000", "999", "999b" } );
+    index.build( store );
+    CHECK( !index.numeric() );
+    CHECK( index.ordered() );
+    CHECK( index.first_at_or_after( "999" ) == 1 );
+    make_frames( store, { "999", "1000", "1000b" } );
+    index.build( store );
+    CHECK( !index.numeric() );
+    CHECK( !index.ordered() ); // In text order, "999" comes after "1000".
+
+    // Unordered: only exact matches, first one from the front, last one from the back.
+    make_frames( store, { "2003", "2001", "2002", "2001" } );
+    index.build( store );
+    CHECK( index.numeric() );
+    CHECK( !index.ordered() );
+    CHECK( index.first_at_or_after( "2001" ) == 1 );
+    CHECK( index.end_at_or_before( "2001" ) == 4 );
+    CHECK( index.first_at_or_after( "2002" ) == 2 );
+    CHECK( index.end_at_or_before( "2003" ) == 1 );
+    CHECK( index.first_at_or_after( "2000" ) == npos );
+    CHECK( index.end_at_or_before( "2009" ) == npos );
+
+    // Empty dataset.
+    make_frames( store, {} );
+    index.build( store );
+    CHECK( index.frames() == 0 );
+    CHECK( index.first_at_or_after( "1" ) == 0 );
+    CHECK( index.end_at_or_before( "1" ) == 0 );
+
+    return check::report();
+}
@@ -0,0 +1,46 @@
+/*!
+ * Diffed output: lines wider than the terminal are clipped instead of
+ * wrapping, so the screen model keeps matching what the terminal shows.
+ */
+
+#include <string>
+
+#include "check.h"
+
+#include "renderer.h"
+
+using namespace bcra;
+
+int main( void )
+{
+    // A 20 cell line on a 10 column terminal.
+    DiffScreen screen{ 2, 5, 10 };
+    FrameBuffer out;
+    screen.render( "abcdefghijklmnopqrst\nxy", out );
+    const std::string first{ out.view() };
+    CHECK( screen.cols() == 10 );
+    CHECK( screen.rows() == 2 );
+    CHECK( first.find( "abcdefghij" ) != std::string::npos );
+    CHECK( first.find( 'k' ) == std::string::npos );
+    CHECK( first.find( 't' ) == std::string::npos );
+
+    // A change past the terminal edge paints nothing.
+    out.clear();
+    screen.render( "abcdefghijklZnopqrst\nxy", out );
+    const std::string clipped{ out.view() };
+    CHECK( clipped.find( 'Z' ) == std::string::npos );
+
+    // A change inside it is still painted.
+    out.clear();
+    screen.render( "abcdeFghijklmnopqrst\nxy", out );
+    CHECK( std::string{ out.view() }.find( 'F' ) != std::string::npos );
+
+    // Without a terminal width the grid grows to fit the frame.
+    DiffScreen wide{ 2, 5 };
+    out.clear();
+    wide.render( "abcdefghijklmnopqrst", out );
+    CHECK( wide.cols() == 20 );
+    CHECK( std::string{ out.view() }.find( 't' ) != std::string::npos );
+
+    return check::report();
+}
@@ -0,0 +1,124 @@
+/*!
+ * Field splitting: the scalar, SSE2 and AVX2 splitters must give the same
+ * fields on every line, including quoted fields, `\r`-terminated lines and
+ * lines whose delimiters and quotes sit at the 16 and 32-byte block edges.
+ * Also checks that escaped quotes are undone by `Fields::unescaped()`.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.h"
+
+#include "cpu.h"
+#include "tokenizer.h"
+
+using namespace bcra;
+
+namespace {
+    using split_fn = std::size_t ( * )( std::string_view, char, Fields & );
+
+    /// The splitters this CPU can run; the first one (scalar) is the reference.
+    std::vector< split_fn > splitters( void )
+    {
+        std::vector< split_fn > fns{ detail::split_fields_scalar };
+        if ( cpu::has_sse2() ) fns.push_back( detail::split_fields_sse2 );
+        if ( cpu::has_avx2() ) fns.push_back( detail::split_fields_avx2 );
+        return fns;
+    }
+
+    bool same( const Fields & a, const Fields & b )
+    {
+        if ( a.count != b.count || a.escaped != b.escaped ) return false;
+        for ( std::size_t i{ 0 }; i < a.count; ++i )
+            if ( a[i] != b[i] ) return false;
+        return true;
+    }
+
+    /// True if every splitter agrees with the scalar one on `line`.
+    bool agree( std::string_view line, char delimiter = ',' )
+    {
+        Fields expected;
+        detail::split_fields_scalar( line, delimiter, expected );
+        for ( auto split : splitters() )
+        {
+            Fields got;
+            if ( split( line, delimiter, got ) != expected.count || !same( got, expected ) ) return false;
+        }
+        return true;
+    }
+}
+
+int main( void )
+{
+    // Quoting.
+    {
+        Fields f;
+        split_fields( "1500,\"Washington, D.C.\",USA,100,North America\r", ',', f );
+        CHECK( f.size() == 5 );
+        CHECK( f[1] == "Washington, D.C." );
+        CHECK( f[4] == "North America" );
+        CHECK( f.escaped == 0 );
+
+        std::string scratch;
+        split_fields( "1500,\"The \"\"Big\"\" One\",x,1,\"\"\"\"", ',', f );
+        CHECK( f.size() == 5 );
+        CHECK( f[1] == "The \"\"Big\"\" One" );
+        CHECK( f.escaped_at( 1 ) );
+        CHECK( f.unescaped( 1, scratch ) == "The \"Big\" One" );
+        CHECK( f.unescaped( 4, scratch ) == "\"" );
+        CHECK( !f.escaped_at( 2 ) );
+        CHECK( f.unescaped( 2, scratch ) == "x" );
+
+        split_fields( "a,b\"\"c,d", ',', f ); // Quotes inside an unquoted field are plain text.
+        CHECK( f.size() == 3 );
+        CHECK( !f.escaped_at( 1 ) );
+        CHECK( f.unescaped( 1, scratch ) == "b\"\"c" );
+    }
+
+    const char * lines[] = {
+        "1500,\"Washington, D.C.\",USA,100,North America\r",
+        "x,\"he said \"\"hi, there\"\"\",y\r",
+        " a , b ,c\r",
+        "a,b\"c,d",
+        "\"unterminated,a,b",
+        "",
+        ",",
+        "\r",
+        "a,,b,",
+        "  \"  q  \" ,z",
+        "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18",
+    };
+    for ( auto line : lines ) CHECK( agree( line ) );
+    CHECK( agree( "a;\"b;c\";d", ';' ) );
+    CHECK( agree( "a\"b\"c", '"' ) ); // The delimiter is the quote: no quoting.
+
+    // A delimiter, a quote or an escaped "" at (and around) every block edge, with and without '\r'.
+    for ( std::size_t edge : { 15, 16, 17, 31, 32, 33, 63, 64 } )
+        for ( const char * piece : { ",", "\"", "\"\"", ",\"", "\",", "\r" } )
+            for ( std::size_t at{ edge - 2 }; at <= edge + 1; ++at )
+            {
+                std::string line( at, 'a' );
+                line[0] = '"'; // Opens a quoted field, so quotes later on mean something.
+                line += piece;
+                line += std::string( 40, 'b' ) + ",\"c,d\",e";
+                CHECK( agree( line ) );
+                CHECK( agree( line + "\r" ) );
+                CHECK( agree( line.substr( 1 ) ) );
+            }
+
+    // Random lines over a tiny alphabet, so delimiters, quotes and blanks collide a lot.
+    std::mt19937 rng{ 20240601u };
+    const char alphabet[] = "ab,\" \r";
+    int mismatches{ 0 };
+    for ( int t{ 0 }; t < 100000; ++t )
+    {
+        std::string line( rng() % 100, ' ' );
+        for ( auto & c : line ) c = alphabet[ rng() % 6 ];
+        if ( !agree( line ) ) ++mismatches;
+    }
+    CHECK( mismatches == 0 );
+
+    return check::report();
+}
@@ -0,0 +1,115 @@
+/*!
+ * Value kernels: the AVX2 `value_stats()` and `bar_widths()` must match the
+ * scalar ones bit for bit, and the scalar widths must match `bar_eighths()`.
+ * The inputs cover values around +-2^51 (where the AVX2 conversion to double
+ * stops being exact and falls back), negatives, `max <= 0` and every tail
+ * length 0-7 left after the 4-wide and 8-wide blocks.
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "check.h"
+
+#include "cpu.h"
+#include "value_kernels.h"
+
+using namespace bcra;
+
+namespace {
+    constexpr value_t two_51 = value_t{ 1 } << 51;
+
+    std::mt19937_64 & rng( void )
+    {
+        static std::mt19937_64 gen{ 20240601u };
+        return gen;
+    }
+
+    /// A value drawn from one of several ranges, picked at random.
+    value_t random_value( void )
+    {
+        auto & r = rng();
+        switch ( r() % 6 )
+        {
+            case 0:  return static_cast<value_t>( r() % 2001 ) - 1000;                          // Small, with negatives.
+            case 1:  return static_cast<value_t>( r() % 1000000 );                              // Typical.
+            case 2:  return two_51 - 8 + static_cast<value_t>( r() % 16 );                      // Around +2^51.
+            case 3:  return -two_51 - 8 + static_cast<value_t>( r() % 16 );                     // Around -2^51.
+            case 4:  return static_cast<value_t>( r() % static_cast<std::uint64_t>( 4 * two_51 ) ) - 2 * two_51;
+            default: return static_cast<value_t>( r() >> 1 );                                   // Up to INT64_MAX.
+        }
+    }
+
+    bool same( const ValueStats & a, const ValueStats & b ) { return a.min == b.min && a.max == b.max && a.sum == b.sum; }
+
+    /// Checks every kernel on `values`, scaled against `max`.
+    bool agree( const std::vector< value_t > & values, value_t max, std::size_t cells, bool avx2 )
+    {
+        const auto n = values.size();
+        std::vector< std::uint32_t > scalar( n + 1, 0xDEAD ), wide( n + 1, 0xDEAD );
+        detail::bar_widths_scalar( values.data(), n, max, cells, scalar.data() );
+        for ( std::size_t i{ 0 }; i < n; ++i )
+            if ( scalar[i] != bar_eighths( values[i], max, cells ) ) return false;
+        if ( scalar[n] != 0xDEAD ) return false; // Nothing written past the end.
+        if ( !avx2 ) return true;
+
+        if ( !same( detail::value_stats_scalar( values.data(), n ), detail::value_stats_avx2( values.data(), n ) ) ) return false;
+        detail::bar_widths_avx2( values.data(), n, max, cells, wide.data() );
+        return wide == scalar;
+    }
+}
+
+int main( void )
+{
+    const bool avx2 = cpu::has_avx2();
+    if ( !avx2 ) std::cout << "No AVX2 on this CPU: only the scalar kernels are checked.\n";
+
+    // Stats of known arrays, every length 0-7 past a multiple of 8.
+    {
+        std::vector< value_t > values;
+        for ( std::size_t n{ 0 }; n < 24; ++n )
+        {
+            const auto stats = detail::value_stats_scalar( values.data(), n );
+            CHECK( stats.sum == static_cast<value_t>( n * ( n - 1 ) / 2 ) - static_cast<value_t>( n ) * 5 );
+            CHECK( n == 0 ? stats.min == 0 && stats.max == 0 : stats.min == -5 && stats.max == static_cast<value_t>( n ) - 6 );
+            if ( avx2 ) CHECK( same( stats, detail::value_stats_avx2( values.data(), n ) ) );
+            values.push_back( static_cast<value_t>( n ) - 5 );
+        }
+        const value_t extremes[] = { std::numeric_limits< value_t >::min(), std::numeric_limits< value_t >::max(), 0, -1, 1 };
+        const auto stats = detail::value_stats_scalar( extremes, 5 );
+        CHECK( stats.min == std::numeric_limits< value_t >::min() );
+        CHECK( stats.max == std::numeric_limits< value_t >::max() );
+        if ( avx2 ) CHECK( same( stats, detail::value_stats_avx2( extremes, 5 ) ) );
+    }
+
+    // Exact halves round up, like llround().
+    {
+        const std::vector< value_t > halves{ 1, 3, 5, 7, 9, 11, 13, 15 };
+        CHECK( agree( halves, 16, 1, avx2 ) );
+    }
+
+    // max <= 0: every bar is empty.
+    for ( value_t max : { value_t{ 0 }, value_t{ -1 }, -two_51, std::numeric_limits< value_t >::min() } )
+    {
+        const std::vector< value_t > values{ 5, -5, 0, two_51, -two_51, 1, 2, 3, 4, 6, 7 };
+        CHECK( agree( values, max, 40, avx2 ) );
+    }
+
+    // Random arrays, every length 0-39 (so every tail), scaled by their own max like a chart.
+    int mismatches{ 0 };
+    for ( int t{ 0 }; t < 50000; ++t )
+    {
+        std::vector< value_t > values( static_cast<std::size_t>( t % 40 ) );
+        for ( auto & v : values ) v = random_value();
+        auto max = detail::value_stats_scalar( values.data(), values.size() ).max;
+        if ( t % 7 == 0 ) max = -max; // Also a non-positive max.
+        const auto cells = 1 + static_cast<std::size_t>( rng()() % 120 );
+        if ( !agree( values, max, cells, avx2 ) ) ++mismatches;
+    }
+    CHECK( mismatches == 0 );
+
+    return check::report();
+}
@@ -0,0 +1,105 @@
+/*!
+ * `parse_value()`: the 64-bit limits, overflow, thousands separators,
+ * decimal places and rounding, and what is rejected as malformed.
+ */
+
+#include <limits>
+#include <string>
+
+#include "check.h"
+
+#include "value_parser.h"
+
+using namespace bcra;
+
+namespace {
+    /// True if `str` parses to exactly `expected`.
+    bool parses( std::string_view str, value_t expected, const ValueFormat & format = ValueFormat{} )
+    {
+        value_t value{ -12345 };
+        return parse_value( str, value, format ) && value == expected;
+    }
+
+    /// True if `str` is rejected.
+    bool rejects( std::string_view str, const ValueFormat & format = ValueFormat{} )
+    {
+        value_t value{ 0 };
+        return !parse_value( str, value, format );
+    }
+
+    ValueFormat with( char thousands, unsigned decimals, char decimal_point = '.' )
+    {
+        ValueFormat format;
+        format.thousands = thousands;
+        format.decimals = decimals;
+        format.decimal_point = decimal_point;
+        return format;
+    }
+}
+
+int main( void )
+{
+    constexpr auto max = std::numeric_limits< value_t >::max();
+    constexpr auto min = std::numeric_limits< value_t >::min();
+
+    // Plain integers, short and long enough for the 8-digit fast path.
+    CHECK( parses( "0", 0 ) );
+    CHECK( parses( "42", 42 ) );
+    CHECK( parses( " -7 \r", -7 ) );
+    CHECK( parses( "+7", 7 ) );
+    CHECK( parses( "12345678", 12345678 ) );
+    CHECK( parses( "123456789012", 123456789012 ) );
+    CHECK( parses( "000000000000000001", 1 ) );
+
+    // The 64-bit limits, and one past them.
+    CHECK( parses( "9223372036854775807", max ) );
+    CHECK( parses( "-9223372036854775808", min ) );
+    CHECK( rejects( "9223372036854775808" ) );
+    CHECK( rejects( "-9223372036854775809" ) );
+    CHECK( rejects( "18446744073709551616" ) );        // Past the u64 accumulator too.
+    CHECK( rejects( "99999999999999999999999999" ) );
+    CHECK( parses( "92233720368547758.07", max, with( '\0', 2 ) ) );
+    CHECK( rejects( "92233720368547758.08", with( '\0', 2 ) ) );
+    CHECK( rejects( "92233720368547758.075", with( '\0', 2 ) ) ); // Rounding up overflows.
+    CHECK( rejects( "9223372036854775807", with( '\0', 1 ) ) );   // Scaling overflows.
+
+    // Malformed.
+    for ( auto bad : { "", " ", "-", "+", "abc", "12a", "1 2", "--1", "0x10", "1e3", "1.", ".5" } )
+        CHECK( rejects( bad ) );
+
+    // No decimals: a fractional part is not a value.
+    CHECK( rejects( "1.5" ) );
+    CHECK( rejects( "1.0" ) );
+    CHECK( rejects( "1,5", with( '\0', 0, ',' ) ) );
+
+    // Decimals, scaled to fixed point and rounded half up on the first dropped digit.
+    CHECK( parses( "1.5", 150, with( '\0', 2 ) ) );
+    CHECK( parses( "1", 100, with( '\0', 2 ) ) );
+    CHECK( parses( "1.005", 101, with( '\0', 2 ) ) );
+    CHECK( parses( "1.004", 100, with( '\0', 2 ) ) );
+    CHECK( parses( "1.0049999", 100, with( '\0', 2 ) ) );
+    CHECK( parses( "-1.005", -101, with( '\0', 2 ) ) );
+    CHECK( parses( "0.999", 100, with( '\0', 2 ) ) );
+    CHECK( parses( "0.123456789", 123456789, with( '\0', 9 ) ) );
+    CHECK( parses( "3,25", 325, with( '\0', 2, ',' ) ) );
+    CHECK( rejects( "1.2.3", with( '\0', 2 ) ) );
+
+    // Thousands separators: 1 to 3 digits, then groups of exactly 3.
+    CHECK( parses( "1,234", 1234, with( ',', 0 ) ) );
+    CHECK( parses( "12,345,678", 12345678, with( ',', 0 ) ) );
+    CHECK( parses( "-1,234,567", -1234567, with( ',', 0 ) ) );
+    CHECK( parses( "1234567", 1234567, with( ',', 0 ) ) ); // Separators are optional.
+    CHECK( parses( "9,223,372,036,854,775,807", max, with( ',', 0 ) ) );
+    CHECK( parses( "1.234.567", 1234567, with( '.', 0, ',' ) ) );
+    CHECK( parses( "1,234.5", 123450, with( ',', 2 ) ) );
+    CHECK( rejects( "1,23", with( ',', 0 ) ) );
+    CHECK( rejects( "1,2345", with( ',', 0 ) ) );
+    CHECK( rejects( "1234,567", with( ',', 0 ) ) );
+    CHECK( rejects( "1,234,56", with( ',', 0 ) ) );
+    CHECK( rejects( "1,,234", with( ',', 0 ) ) );
+    CHECK( rejects( ",234", with( ',', 0 ) ) );
+    CHECK( rejects( "1,234,", with( ',', 0 ) ) );
+    CHECK( rejects( "1,234", with( '\0', 0 ) ) ); // No separator configured.
+
+    return check::report();
+}
@@ -0,0 +1,305 @@
+/** @file bcr_gen.cpp
+ *
+ * @description
+ * Generates synthetic bar chart race datasets, for scale and stress testing.
+ *
+ * The output has the same format `bcr` reads: a 3 line header, then for each
+ * frame a blank line, the # of records and one record per line:
+ * ```
+ *     <timestamp>,<label>,<country>,<value>,<category>
+ * ```
+ * Everything is formatted by hand into a large buffer that is written in big
+ * blocks, so the generator is limited by the disk, not by the CPU.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "coms.h"
+
+namespace {
+    /// How the values of the bars are drawn.
+    enum class dist_e : unsigned char {
+        WALK = 0, //!< Each label starts somewhere and grows/shrinks a little every frame (a real race).
+        UNIFORM,  //!< Independent values, uniform in [1,max].
+        SKEWED    //!< Independent values, heavy tailed: few big bars, many small ones.
+    };
+
+    /// Command line options.
+    struct Options {
+        std::size_t frames = 100;    //!< # of frames (charts).
+        std::size_t items = 1000;    //!< # of records per frame.
+        std::size_t labels = 0;      //!< # of distinct labels (0 means the same as `items`).
+        std::size_t categories = 12; //!< # of distinct categories.
+        std::int64_t max_value = 1000000; //!< Largest value drawn.
+        std::int64_t start = 1500;   //!< Time stamp of the first frame (one per frame after that).
+        std::uint64_t seed = 1;      //!< Seed of the random generator.
+        dist_e dist = dist_e::WALK;  //!< Value distribution.
+        std::string output;          //!< Output file (empty means the standard output).
+    };
+
+    /// splitmix64: tiny, fast and good enough for test data.
+    class Random {
+        public:
+            explicit Random( std::uint64_t seed ) : m_state{ seed } {}
+            std::uint64_t next( void )
+            {
+                std::uint64_t z = ( m_state += 0x9E3779B97F4A7C15ull );
+                z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+                z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+                return z ^ ( z >> 31 );
+            }
+            /// Uniform in [0,1).
+            double unit( void ) { return static_cast<double>( next() >> 11 ) * 0x1.0p-53; }
+            /// Uniform in [0,n).
+            std::uint64_t below( std::uint64_t n ) { return n == 0 ? 0 : next() % n; }
+        private:
+            std::uint64_t m_state;
+    };
+
+    /// Output buffer written in big blocks.
+    class Writer {
+        public:
+            static constexpr std::size_t block = 4u << 20;
+
+            explicit Writer( std::FILE * file ) : m_file{ file } { m_buffer.resize( block + 256 ); }
+            ~Writer() { flush(); }
+
+            /// Where the next record goes; at most 256 bytes may be written before `commit()`.
+            char * reserve( void )
+            {
+                if ( m_size >= block ) flush();
+                return m_buffer.data() + m_size;
+            }
+            void commit( char * end ) { m_size = static_cast<std::size_t>( end - m_buffer.data() ); }
+
+            void append( std::string_view text )
+            {
+                if ( m_size + text.size() > m_buffer.size() ) flush();
+                if ( text.size() > m_buffer.size() ) { write( text.data(), text.size() ); return; }
+                std::memcpy( m_buffer.data() + m_size, text.data(), text.size() );
+                m_size += text.size();
+            }
+
+            void flush( void )
+            {
+                write( m_buffer.data(), m_size );
+                m_size = 0;
+            }
+
+            std::uint64_t bytes( void ) const { return m_total + m_size; }
+
+        private:
+            void write( const char * data, std::size_t size )
+            {
+                if ( size > 0 && std::fwrite( data, 1, size, m_file ) != size )
+                    coms::Error( "nao foi possivel escrever a saida" );
+                m_total += size;
+            }
+
+            std::FILE * m_file;
+            std::vector< char > m_buffer;
+            std::size_t m_size = 0;
+            std::uint64_t m_total = 0;
+    };
+
+    /// "00".."99", so numbers are written two digits at a time.
+    constexpr char digit_pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    /// Writes `value` in decimal at `out`; returns the end.
+    inline char * put_uint( char * out, std::uint64_t value )
+    {
+        char digits[20];
+        char * p = digits + sizeof( digits );
+        while ( value >= 100 )
+        {
+            p -= 2;
+            std::memcpy( p, digit_pairs + 2 * ( value % 100 ), 2 );
+            value /= 100;
+        }
+        if ( value >= 10 ) { p -= 2; std::memcpy( p, digit_pairs + 2 * value, 2 ); }
+        else *--p = static_cast<char>( '0' + value );
+        const auto len = static_cast<std::size_t>( digits + sizeof( digits ) - p );
+        std::memcpy( out, p, len );
+        return out + len;
+    }
+
+    /// Copies a preformatted piece of a record.
+    inline char * put( char * out, const std::string & text )
+    {
+        std::memcpy( out, text.data(), text.size() );
+        return out + text.size();
+    }
+
+    void usage( const std::string & msg = "" )
+    {
+        if ( !msg.empty() ) std::cerr << "ERR: " << msg << "\n\n";
+        std::cerr << "Usage: bcr_gen [<options>] [-o <output_file>]\n"
+            << "  Synthetic dataset options:\n"
+            << "      -n  <num> # of frames. Default value is 100.\n"
+            << "      -i  <num> # of items (records) per frame. Default value is 1000.\n"
+            << "      -l  <num> # of distinct labels; each frame shows <items> of them and the set\n"
+            << "                drifts from frame to frame. Must be >= items. Default is <items>.\n"
+            << "      -c  <num> # of distinct categories. Default value is 12.\n"
+            << "      -d  <walk|uniform|skewed> Value distribution. 'walk' makes every label drift\n"
+            << "                a little each frame, like a real race. Default is walk.\n"
+            << "      -m  <num> Largest value. Default value is 1000000.\n"
+            << "      -s  <num> Random seed. Default value is 1.\n"
+            << "      --start <num> Time stamp of the first frame. Default value is 1500.\n"
+            << "      -o  <file> Output file. Default is the standard output.\n";
+        std::cerr << '\n';
+        std::exit( msg.empty() ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+
+    /// Reads the number after option `argv[i]`, which must lie in [lo,hi].
+    std::int64_t number( int argc, char ** argv, int & i, std::int64_t lo, std::int64_t hi )
+    {
+        const std::string name{ argv[i] };
+        if ( ++i >= argc ) usage( "Faltou argumento para " + name );
+        char * end{ nullptr };
+        const long long value = std::strtoll( argv[i], &end, 10 );
+        if ( *argv[i] == '\0' || *end != '\0' || value < lo || value > hi )
+            usage( "Valor invalido para " + name + ": '" + argv[i] + "'. Tente algo em ["
+                   + std::to_string( lo ) + "," + std::to_string( hi ) + "]." );
+        return value;
+    }
+
+    Options parse( int argc, char ** argv )
+    {
+        Options opt;
+        constexpr std::int64_t big = std::int64_t{ 1 } << 40;
+        for ( int i{ 1 }; i < argc; ++i )
+        {
+            const std::string param{ argv[i] };
+            if ( param == "-h" || param == "--help" ) usage();
+            else if ( param == "-n" ) opt.frames = number( argc, argv, i, 1, big );
+            else if ( param == "-i" ) opt.items = number( argc, argv, i, 1, big );
+            else if ( param == "-l" ) opt.labels = number( argc, argv, i, 1, big );
+            else if ( param == "-c" ) opt.categories = number( argc, argv, i, 1, big );
+            else if ( param == "-m" ) opt.max_value = number( argc, argv, i, 1, std::int64_t{ 1 } << 62 );
+            else if ( param == "-s" ) opt.seed = number( argc, argv, i, 0, big );
+            else if ( param == "--start" ) opt.start = number( argc, argv, i, 0, big );
+            else if ( param == "-d" )
+            {
+                if ( ++i >= argc ) usage( "Faltou argumento para -d" );
+                const std::string dist{ argv[i] };
+                if ( dist == "walk" ) opt.dist = dist_e::WALK;
+                else if ( dist == "uniform" ) opt.dist = dist_e::UNIFORM;
+                else if ( dist == "skewed" ) opt.dist = dist_e::SKEWED;
+                else usage( "Distribuicao desconhecida: '" + dist + "'. Use walk, uniform ou skewed." );
+            }
+            else if ( param == "-o" )
+            {
+                if ( ++i >= argc ) usage( "Faltou argumento para -o" );
+                opt.output = argv[i];
+            }
+            else usage( "Opcao desconhecida: '" + param + "'" );
+        }
+        if ( opt.labels == 0 ) opt.labels = opt.items;
+        if ( opt.labels < opt.items )
+            usage( "O # de rotulos (-l) precisa ser pelo menos o # de itens por quadro (-i)." );
+        return opt;
+    }
+
+    /// Draws a fresh value.
+    std::int64_t draw( Random & rng, const Options & opt )
+    {
+        const double u = rng.unit();
+        const double scale = static_cast<double>( opt.max_value - 1 );
+        switch ( opt.dist )
+        {
+            case dist_e::SKEWED: return 1 + static_cast<std::int64_t>( scale * u * u * u * u );
+            default:             return 1 + static_cast<std::int64_t>( scale * u );
+        }
+    }
+} // namespace.
+
+int main( int argc, char ** argv )
+{
+    const Options opt = parse( argc, argv );
+
+    std::FILE * file = stdout;
+    if ( !opt.output.empty() )
+    {
+        file = std::fopen( opt.output.c_str(), "wb" );
+        if ( file == nullptr ) coms::Error( "nao foi possivel criar '" + opt.output + "'" );
+    }
+    std::setvbuf( file, nullptr, _IONBF, 0 ); // Writer already hands over big blocks.
+
+    const auto t_begin = std::chrono::steady_clock::now();
+    Random rng{ opt.seed };
+
+    // Everything about a label but its value is formatted once: ",<label>,<country>,".
+    std::vector< std::string > label_text( opt.labels );
+    for ( std::size_t i{ 0 }; i < opt.labels; ++i )
+        label_text[i] = ",Label " + std::to_string( i ) + ",Country " + std::to_string( i % 193 ) + ",";
+    // ... and the category, with the end of the line: ",<category>\n".
+    std::vector< std::string > category_text( opt.categories );
+    for ( std::size_t i{ 0 }; i < opt.categories; ++i )
+        category_text[i] = ",Category " + std::to_string( i ) + "\n";
+    std::vector< std::uint32_t > label_category( opt.labels );
+    for ( auto & c : label_category ) c = static_cast<std::uint32_t>( rng.below( opt.categories ) );
+
+    // Values live on between frames, so that a label can walk.
+    std::vector< std::int64_t > values( opt.labels );
+    for ( auto & v : values ) v = draw( rng, opt );
+
+    // Each frame shows a window of `items` labels; the window slides a bit every frame.
+    const std::size_t shift = opt.labels == opt.items ? 0 : std::max< std::size_t >( 1, opt.items / 10 );
+
+    {
+        Writer out{ file };
+        out.append( "Synthetic bar chart race\nValue (units)\nSource: bcr_gen (seed "
+                    + std::to_string( opt.seed ) + ")\n" );
+        const std::string count = "\n" + std::to_string( opt.items ) + "\n";
+        std::size_t offset{ 0 };
+        for ( std::size_t f{ 0 }; f < opt.frames; ++f )
+        {
+            out.append( count );
+            char stamp[24];
+            const auto stamp_len = static_cast<std::size_t>( put_uint( stamp, opt.start + f ) - stamp );
+            for ( std::size_t k{ 0 }; k < opt.items; ++k )
+            {
+                std::size_t label = offset + k;
+                if ( label >= opt.labels ) label -= opt.labels;
+                auto & value = values[label];
+                if ( opt.dist == dist_e::WALK )
+                {
+                    // Mostly growth, some decline: +-5% of the value, plus a bit.
+                    const auto step = static_cast<std::int64_t>( rng.below( value / 10 + 3 ) ) - value / 20;
+                    value = std::clamp< std::int64_t >( value + step, 1, opt.max_value );
+                }
+                else if ( f > 0 )
+                    value = draw( rng, opt );
+
+                char * p = out.reserve();
+                std::memcpy( p, stamp, stamp_len );
+                p = put( p + stamp_len, label_text[label] );
+                p = put_uint( p, static_cast<std::uint64_t>( value ) );
+                p = put( p, category_text[ label_category[label] ] );
+                out.commit( p );
+            }
+            offset += shift;
+            if ( offset >= opt.labels ) offset -= opt.labels;
+        }
+        out.flush();
+
+        const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - t_begin ).count();
+        std::cerr << "bcr_gen: " << opt.frames << " frames x " << opt.items << " items, "
+                  << out.bytes() / ( 1024.0 * 1024.0 ) << " MiB in " << seconds << " s ("
+                  << out.bytes() / ( 1024.0 * 1024.0 ) / std::max( seconds, 1e-9 ) << " MiB/s).\n";
+    }
+    if ( file != stdout ) std::fclose( file );
+    return EXIT_SUCCESS;
+}